@@ -0,0 +1,16 @@
+﻿#include "bench.h"
+#define CINI_IMPLEMENTATION
+#include "cini.h"
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+    bench_lookup();
+    bench_number();
+    bench_parse();
+    bench_shape();
+    bench_thread();
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <stdio.h>
+
+#define BENCH_PRINT(file, ...) fprintf(file, __VA_ARGS__)
+
+#ifdef __cplusplus
+extern "C" {
+#endif //__cplusplus
+
+void bench_lookup(void);
+void bench_number(void);
+void bench_parse(void);
+void bench_shape(void);
+void bench_thread(void);
+
+// Value types of the generated file
+enum {
+    BENCH_VALUE_INT,
+    BENCH_VALUE_NUMBER, // Integer, decimal, exponent and hexadecimal
+    BENCH_VALUE_STRING, // Quoted and unquoted strings
+};
+
+// Shape of the generated file, the sections are "section<n>" and the keys are "key<n>"
+typedef struct {
+    const char* name;
+    int num_sections; // Number of distinct section names
+    int repeat;       // Number of times each section appears, the keys are split into them and key0 is duplicated
+    int num_keys;     // Number of distinct keys per section
+    int num_elements; // Number of array elements per value
+    int value_type;
+} BENCH_SHAPE;
+
+extern const BENCH_SHAPE bench_shapes[];
+extern const int bench_shape_count;
+
+double get_time_ns(void);
+unsigned int get_random(unsigned int* state);
+int write_ini_file(const char* path, int num_sections, int num_keys);
+int write_shape_file(const char* path, const BENCH_SHAPE* shape);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
@@ -0,0 +1,79 @@
+﻿#include "bench.h"
+#include "cini.h"
+
+#include <stdio.h>
+
+#define BENCH_LOOKUP_COUNT   1000000
+#define BENCH_LOOKUP_QUERIES 4096
+
+static double bench_lookup_names(HCINI hcini, char (*sections)[32], char (*keys)[32], long long* sum)
+{
+    double start = get_time_ns();
+    for (int n = 0; n < BENCH_LOOKUP_COUNT; ++n) {
+        int q = n % BENCH_LOOKUP_QUERIES;
+        *sum += cini_geti(hcini, sections[q], keys[q], 0);
+    }
+    return get_time_ns() - start;
+}
+
+void bench_lookup(void)
+{
+    // The cost per lookup should stay flat while the number of entries grows
+    static const int shapes[][2] = {
+        { 10, 10 },
+        { 100, 10 },
+        { 100, 100 },
+        { 1000, 100 },
+        { 1000, 1000 },
+    };
+    const char* path = "bench_lookup.ini";
+
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "---------- bench_lookup ----------\n");
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "sections\tkeys\tentries\tns/lookup\tns/key\tns/lookup(compact)\n");
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i) {
+        int num_sections = shapes[i][0];
+        int num_keys = shapes[i][1];
+        if (!write_ini_file(path, num_sections, num_keys)) {
+            BENCH_PRINT(stderr, "Cannot write %s\n", path);
+            return;
+        }
+        HCINI hcini = cini_create(path);
+
+        // Prepare the names outside of the measurement
+        static char sections[BENCH_LOOKUP_QUERIES][32];
+        static char keys[BENCH_LOOKUP_QUERIES][32];
+        unsigned int state = 2463534242u;
+        for (int q = 0; q < BENCH_LOOKUP_QUERIES; ++q) {
+            snprintf(sections[q], sizeof(sections[q]), "section%u", get_random(&state) % (unsigned int)num_sections);
+            snprintf(keys[q], sizeof(keys[q]), "key%u", get_random(&state) % (unsigned int)num_keys);
+        }
+
+        long long sum = 0;
+        double elapsed = bench_lookup_names(hcini, sections, keys, &sum);
+
+        // Same queries with the keys resolved in advance
+        static CINI_KEY resolved_keys[BENCH_LOOKUP_QUERIES];
+        for (int q = 0; q < BENCH_LOOKUP_QUERIES; ++q) {
+            resolved_keys[q] = cini_lookup(hcini, sections[q], keys[q]);
+        }
+        double start = get_time_ns();
+        for (int n = 0; n < BENCH_LOOKUP_COUNT; ++n) {
+            sum += cini_key_geti(hcini, resolved_keys[n % BENCH_LOOKUP_QUERIES], 0);
+        }
+        double key_elapsed = get_time_ns() - start;
+
+        // Same queries on the flat tables
+        cini_compact(hcini);
+        double compact_elapsed = bench_lookup_names(hcini, sections, keys, &sum);
+
+        BENCH_PRINT(stdout, "%d\t%d\t%d\t%.1f\t%.1f\t%.1f\t(checksum:%lld)\n",
+            num_sections, num_keys, num_sections * num_keys, elapsed / BENCH_LOOKUP_COUNT, key_elapsed / BENCH_LOOKUP_COUNT,
+            compact_elapsed / BENCH_LOOKUP_COUNT, sum);
+
+        cini_free(hcini);
+    }
+    remove(path);
+}
@@ -0,0 +1,75 @@
+﻿#include "bench.h"
+#include "cini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_NUMBER_COUNT 100000
+#define BENCH_NUMBER_WIDTH 32
+
+static void bench_number_format(const char* name, const char* format, int is_float)
+{
+    // Same numbers are converted by strtod and by the getter of the array (the array is split before the measurement)
+    static char numbers[BENCH_NUMBER_COUNT][BENCH_NUMBER_WIDTH];
+    static float values[BENCH_NUMBER_COUNT];
+    const char* prefix = "[numbers]\nvalues = ";
+    size_t prefix_len = strlen(prefix);
+    size_t capacity = prefix_len + (size_t)BENCH_NUMBER_COUNT * BENCH_NUMBER_WIDTH;
+    char* data = (char*)malloc(capacity);
+    if (data == NULL) {
+        return;
+    }
+    size_t len = prefix_len;
+    unsigned int state = 2463534242u;
+    memcpy(data, prefix, prefix_len);
+    for (int i = 0; i < BENCH_NUMBER_COUNT; ++i) {
+        unsigned int r = get_random(&state);
+        if (is_float) {
+            snprintf(numbers[i], sizeof(numbers[i]), format, (double)r / 4096.0);
+        } else {
+            snprintf(numbers[i], sizeof(numbers[i]), format, r % 1000000u);
+        }
+        int written = snprintf(data + len, capacity - len, (i == 0) ? "%s" : ",%s", numbers[i]);
+        if (written < 0 || capacity - len <= (size_t)written) {
+            free(data);
+            return;
+        }
+        len += (size_t)written;
+    }
+
+    double sum = 0.0;
+    double start = get_time_ns();
+    for (int i = 0; i < BENCH_NUMBER_COUNT; ++i) {
+        sum += strtod(numbers[i], NULL);
+    }
+    double strtod_elapsed = get_time_ns() - start;
+
+    HCINI hcini = cini_create_from_buffer(data, len, NULL);
+    int count = cini_getcount(hcini, "numbers", "values");
+    start = get_time_ns();
+    count = cini_getaf_range(hcini, "numbers", "values", values, count);
+    double cini_elapsed = get_time_ns() - start;
+    for (int i = 0; i < count; ++i) {
+        sum += values[i];
+    }
+    cini_free(hcini);
+    free(data);
+
+    BENCH_PRINT(stdout, "%s\t%d\t%.1f\t%.1f\t(checksum:%.0f)\n",
+        name, count, strtod_elapsed / BENCH_NUMBER_COUNT, cini_elapsed / BENCH_NUMBER_COUNT, sum);
+}
+
+void bench_number(void)
+{
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "---------- bench_number ----------\n");
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "format\tvalues\tns/strtod\tns/cini\n");
+
+    bench_number_format("integer", "%u", 0);
+    bench_number_format("hexadecimal", "0x%X", 0);
+    bench_number_format("fixed", "%.3f", 1);
+    bench_number_format("exponent", "%.6e", 1);
+    bench_number_format("shortest", "%.17g", 1);
+}
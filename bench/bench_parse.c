@@ -0,0 +1,133 @@
+﻿#include "bench.h"
+#include "cini.h"
+
+#include <stdio.h>
+
+#define BENCH_PARSE_REPEAT 5
+#define BENCH_PARSE_FILES  4
+
+static void bench_parse_file(const char* name, const char* path, HCINI (*create_func)(const char*, const char*), const char* section)
+{
+    FILE* file = fopen(path, "rb");
+    long file_size = 0;
+    if (file != NULL) {
+        fseek(file, 0, SEEK_END);
+        file_size = ftell(file);
+        fclose(file);
+    }
+
+    double best = 0.0;
+    for (int n = 0; n < BENCH_PARSE_REPEAT; ++n) {
+        double start = get_time_ns();
+        HCINI hcini = create_func(path, section);
+        double elapsed = get_time_ns() - start;
+        cini_free(hcini);
+        best = (n == 0 || elapsed < best) ? elapsed : best;
+    }
+    BENCH_PRINT(stdout, "%s\t%ld\t%.2f\t%.1f\n", name, file_size, best / 1e6, (double)file_size / 1e6 / (best / 1e9));
+}
+
+static void bench_parse_many(const char* path, int threads)
+{
+    // Same file is loaded several times, serially (threads = 1) or in parallel
+    const char* paths[BENCH_PARSE_FILES];
+    HCINI handles[BENCH_PARSE_FILES];
+    char name[64];
+    long file_size = 0;
+    FILE* file = fopen(path, "rb");
+    if (file != NULL) {
+        fseek(file, 0, SEEK_END);
+        file_size = ftell(file) * BENCH_PARSE_FILES;
+        fclose(file);
+    }
+    for (int i = 0; i < BENCH_PARSE_FILES; ++i) {
+        paths[i] = path;
+    }
+
+    double best = 0.0;
+    for (int n = 0; n < BENCH_PARSE_REPEAT; ++n) {
+        double start = get_time_ns();
+        cini_create_many(paths, BENCH_PARSE_FILES, handles, threads);
+        double elapsed = get_time_ns() - start;
+        for (int i = 0; i < BENCH_PARSE_FILES; ++i) {
+            cini_free(handles[i]);
+        }
+        best = (n == 0 || elapsed < best) ? elapsed : best;
+    }
+    snprintf(name, sizeof(name), "cini_create_many(%d files, %d threads)", BENCH_PARSE_FILES, threads);
+    BENCH_PRINT(stdout, "%s\t%ld\t%.2f\t%.1f\n", name, file_size, best / 1e6, (double)file_size / 1e6 / (best / 1e9));
+}
+
+static HCINI bench_create_compiled(const char* path, const char* section)
+{
+    (void)section;
+    return cini_create_compiled(path);
+}
+
+static HCINI bench_create_parallel(const char* path, const char* section)
+{
+    (void)section;
+    return cini_create_parallel(path, 0);
+}
+
+static HCINI bench_create_lazy(const char* path, const char* section)
+{
+    // The section is parsed by the first access
+    HCINI hcini = cini_create_lazy(path);
+    if (section != NULL) {
+        cini_geti(hcini, section, "key0", 0);
+    }
+    return hcini;
+}
+
+static int bench_count_value(void* user_data, const char* value, size_t len, int quoted)
+{
+    (void)value;
+    (void)quoted;
+    *(size_t*)user_data += len;
+    return 1;
+}
+
+static HCINI bench_parse_events(const char* path, const char* section)
+{
+    // Stream the values without building the handle
+    static size_t value_bytes = 0;
+    CINI_EVENTS events = { NULL, NULL, bench_count_value, NULL, NULL };
+    (void)section;
+    cini_parse_events(path, &events, &value_bytes);
+    return NULL;
+}
+
+void bench_parse(void)
+{
+    const char* path = "bench_parse.ini";
+    const char* compiled_path = "bench_parse.cini";
+
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "---------- bench_parse ----------\n");
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "function\tbytes\tms\tMB/s\n");
+
+    if (!write_ini_file(path, 1000, 1000)) {
+        BENCH_PRINT(stderr, "Cannot write %s\n", path);
+        return;
+    }
+    bench_parse_file("cini_create_with_section(all)", path, cini_create_with_section, NULL);
+    bench_parse_file("cini_create_with_section(1)", path, cini_create_with_section, "section500");
+    bench_parse_file("cini_create_mmap(all)", path, cini_create_mmap, NULL);
+    bench_parse_file("cini_create_mmap(1)", path, cini_create_mmap, "section500");
+    bench_parse_file("cini_create_parallel(all)", path, bench_create_parallel, NULL);
+    bench_parse_file("cini_create_lazy(open)", path, bench_create_lazy, NULL);
+    bench_parse_file("cini_create_lazy(1)", path, bench_create_lazy, "section500");
+    bench_parse_file("cini_parse_events(all)", path, bench_parse_events, NULL);
+    bench_parse_many(path, 1);
+    bench_parse_many(path, BENCH_PARSE_FILES);
+
+    HCINI hcini = cini_create(path);
+    if (cini_save_compiled(hcini, compiled_path)) {
+        bench_parse_file("cini_create_compiled", compiled_path, bench_create_compiled, NULL);
+        remove(compiled_path);
+    }
+    cini_free(hcini);
+    remove(path);
+}
@@ -0,0 +1,132 @@
+﻿#include "bench.h"
+#include "cini.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_SHAPE_REPEAT  5
+#define BENCH_SHAPE_COUNT   1000000
+#define BENCH_SHAPE_QUERIES 4096
+
+// Tracks the peak of the bytes held by a handle
+typedef struct {
+    size_t current;
+    size_t peak;
+} BENCH_SHAPE_MEMORY;
+
+typedef union {
+    size_t size;
+    double align; // Keeps the returned block aligned
+} BENCH_SHAPE_BLOCK;
+
+static void* bench_shape_alloc(void* user_data, size_t size)
+{
+    BENCH_SHAPE_MEMORY* memory = (BENCH_SHAPE_MEMORY*)user_data;
+    BENCH_SHAPE_BLOCK* block = (BENCH_SHAPE_BLOCK*)malloc(sizeof(BENCH_SHAPE_BLOCK) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->size = size;
+    memory->current += size;
+    memory->peak = (memory->peak < memory->current) ? memory->current : memory->peak;
+    return block + 1;
+}
+
+static void bench_shape_free(void* user_data, void* ptr)
+{
+    BENCH_SHAPE_MEMORY* memory = (BENCH_SHAPE_MEMORY*)user_data;
+    if (ptr != NULL) {
+        BENCH_SHAPE_BLOCK* block = (BENCH_SHAPE_BLOCK*)ptr - 1;
+        memory->current -= block->size;
+        free(block);
+    }
+}
+
+static double bench_shape_create(const char* path, const char* section)
+{
+    double best = 0.0;
+    for (int n = 0; n < BENCH_SHAPE_REPEAT; ++n) {
+        double start = get_time_ns();
+        HCINI hcini = (section != NULL) ? cini_create_with_section(path, section) : cini_create(path);
+        double elapsed = get_time_ns() - start;
+        cini_free(hcini);
+        best = (n == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+void bench_shape(void)
+{
+    // Representative shapes of real files, see bench_shapes
+    const char* path = "bench_shape.ini";
+
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "---------- bench_shape ----------\n");
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "shape\tbytes\tMB/s(create)\tMB/s(section)\tpeak KB\tns/geti\tns/getai\tns/getcount\n");
+
+    for (int i = 0; i < bench_shape_count; ++i) {
+        const BENCH_SHAPE* shape = &bench_shapes[i];
+        if (!write_shape_file(path, shape)) {
+            BENCH_PRINT(stderr, "Cannot write %s\n", path);
+            return;
+        }
+        FILE* file = fopen(path, "rb");
+        long file_size = 0;
+        if (file != NULL) {
+            fseek(file, 0, SEEK_END);
+            file_size = ftell(file);
+            fclose(file);
+        }
+
+        char section[32];
+        snprintf(section, sizeof(section), "section%d", shape->num_sections / 2);
+        double create_elapsed = bench_shape_create(path, NULL);
+        double section_elapsed = bench_shape_create(path, section);
+
+        BENCH_SHAPE_MEMORY memory = { 0, 0 };
+        CINI_ALLOCATOR allocator = { bench_shape_alloc, bench_shape_free, &memory };
+        HCINI hcini = cini_create_ex(path, NULL, 0, &allocator);
+
+        // Prepare the names outside of the measurement
+        static char sections[BENCH_SHAPE_QUERIES][32];
+        static char keys[BENCH_SHAPE_QUERIES][32];
+        static int indexes[BENCH_SHAPE_QUERIES];
+        unsigned int state = 2463534242u;
+        for (int q = 0; q < BENCH_SHAPE_QUERIES; ++q) {
+            snprintf(sections[q], sizeof(sections[q]), "section%u", get_random(&state) % (unsigned int)shape->num_sections);
+            snprintf(keys[q], sizeof(keys[q]), "key%u", get_random(&state) % (unsigned int)shape->num_keys);
+            indexes[q] = (int)(get_random(&state) % (unsigned int)shape->num_elements);
+        }
+
+        long long sum = 0;
+        double start = get_time_ns();
+        for (int n = 0; n < BENCH_SHAPE_COUNT; ++n) {
+            int q = n % BENCH_SHAPE_QUERIES;
+            sum += cini_geti(hcini, sections[q], keys[q], 0);
+        }
+        double geti_elapsed = get_time_ns() - start;
+
+        start = get_time_ns();
+        for (int n = 0; n < BENCH_SHAPE_COUNT; ++n) {
+            int q = n % BENCH_SHAPE_QUERIES;
+            sum += cini_getai(hcini, sections[q], keys[q], indexes[q], 0);
+        }
+        double getai_elapsed = get_time_ns() - start;
+
+        start = get_time_ns();
+        for (int n = 0; n < BENCH_SHAPE_COUNT; ++n) {
+            int q = n % BENCH_SHAPE_QUERIES;
+            sum += cini_getcount(hcini, sections[q], keys[q]);
+        }
+        double getcount_elapsed = get_time_ns() - start;
+        cini_free(hcini);
+
+        BENCH_PRINT(stdout, "%s\t%ld\t%.1f\t%.1f\t%lu\t%.1f\t%.1f\t%.1f\t(checksum:%lld)\n",
+            shape->name, file_size, (double)file_size / 1e6 / (create_elapsed / 1e9),
+            (double)file_size / 1e6 / (section_elapsed / 1e9), (unsigned long)(memory.peak / 1024),
+            geti_elapsed / BENCH_SHAPE_COUNT, getai_elapsed / BENCH_SHAPE_COUNT,
+            getcount_elapsed / BENCH_SHAPE_COUNT, sum);
+    }
+    remove(path);
+}
@@ -0,0 +1,78 @@
+﻿#include "bench.h"
+#include "cini.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#define BENCH_THREAD_COUNT   1000000
+#define BENCH_THREAD_QUERIES 4096
+#define BENCH_THREAD_MAX     64
+
+static void bench_thread_getters(const char* name, HCINI hcini, int num_threads)
+{
+    // Every thread reads the same handle with its own query sequence
+    static char sections[BENCH_THREAD_QUERIES][32];
+    static char keys[BENCH_THREAD_QUERIES][32];
+    unsigned int state = 2463534242u;
+    for (int q = 0; q < BENCH_THREAD_QUERIES; ++q) {
+        snprintf(sections[q], sizeof(sections[q]), "section%u", get_random(&state) % 100u);
+        snprintf(keys[q], sizeof(keys[q]), "key%u", get_random(&state) % 100u);
+    }
+
+    std::atomic<bool> start(false);
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([hcini, t, &start, &sum] {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            long long local_sum = 0;
+            for (int n = 0; n < BENCH_THREAD_COUNT; ++n) {
+                int q = (n + t * 97) % BENCH_THREAD_QUERIES;
+                local_sum += cini_geti(hcini, sections[q], keys[q], 0);
+                local_sum += cini_gets(hcini, sections[q], keys[q], "")[0];
+            }
+            sum.fetch_add(local_sum);
+        });
+    }
+    double begin = get_time_ns();
+    start.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = get_time_ns() - begin;
+    double lookups = 2.0 * BENCH_THREAD_COUNT * num_threads;
+    BENCH_PRINT(stdout, "%s\t%d\t%.1f\t(checksum:%lld)\n", name, num_threads, lookups / (elapsed / 1e3), sum.load());
+}
+
+void bench_thread(void)
+{
+    const char* path = "bench_thread.ini";
+
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "---------- bench_thread ----------\n");
+    BENCH_PRINT(stdout, "\n");
+    BENCH_PRINT(stdout, "handle\tthreads\tMlookups/s\n");
+
+    if (!write_ini_file(path, 100, 100)) {
+        BENCH_PRINT(stderr, "Cannot write %s\n", path);
+        return;
+    }
+    unsigned int max_threads = std::thread::hardware_concurrency();
+    max_threads = (max_threads == 0 || BENCH_THREAD_MAX < max_threads) ? BENCH_THREAD_MAX : max_threads;
+    for (unsigned int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        // The first access converts the values under the lock
+        HCINI hcini = cini_create_mmap(path, NULL);
+        bench_thread_getters("lazy", hcini, (int)num_threads);
+        cini_free(hcini);
+
+        hcini = cini_create_mmap(path, NULL);
+        cini_preload(hcini);
+        bench_thread_getters("preloaded", hcini, (int)num_threads);
+        cini_free(hcini);
+    }
+    remove(path);
+}
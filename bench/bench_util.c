@@ -0,0 +1,118 @@
+﻿#include "bench.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+double get_time_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+unsigned int get_random(unsigned int* state)
+{
+    // xorshift32: Deterministic between runs and platforms
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+int write_ini_file(const char* path, int num_sections, int num_keys)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    for (int s = 0; s < num_sections; ++s) {
+        fprintf(file, "[section%d]\n", s);
+        for (int k = 0; k < num_keys; ++k) {
+            fprintf(file, "key%d = %d\n", k, s * num_keys + k);
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+const BENCH_SHAPE bench_shapes[] = {
+    { "small sections", 20000, 1, 5, 1, BENCH_VALUE_INT },
+    { "huge sections", 4, 1, 25000, 1, BENCH_VALUE_INT },
+    { "long arrays", 100, 1, 10, 200, BENCH_VALUE_INT },
+    { "numeric", 1000, 1, 50, 1, BENCH_VALUE_NUMBER },
+    { "string", 1000, 1, 50, 1, BENCH_VALUE_STRING },
+    { "duplicates", 200, 20, 100, 1, BENCH_VALUE_INT },
+};
+const int bench_shape_count = (int)(sizeof(bench_shapes) / sizeof(bench_shapes[0]));
+
+static void write_value(FILE* file, int value_type, unsigned int* state)
+{
+    unsigned int r = get_random(state);
+    if (value_type == BENCH_VALUE_INT) {
+        fprintf(file, "%u", r % 1000000u);
+    } else if (value_type == BENCH_VALUE_NUMBER) {
+        switch (r % 4) {
+        case 0:
+            fprintf(file, "%d", (int)(r % 2000001u) - 1000000);
+            break;
+        case 1:
+            fprintf(file, "%.6f", (double)r / 65536.0);
+            break;
+        case 2:
+            fprintf(file, "%.3e", (double)r * 1e-3);
+            break;
+        default:
+            fprintf(file, "0x%X", r);
+            break;
+        }
+    } else {
+        // Quoted string has a comma inside
+        int len = 8 + (int)(r % 48);
+        int quoted = (r / 64) % 4 == 0;
+        fputs(quoted ? "\"" : "", file);
+        for (int i = 0; i < len; ++i) {
+            fputc((quoted && i == len / 2) ? ',' : 'a' + (int)(get_random(state) % 26), file);
+        }
+        fputs(quoted ? "\"" : "", file);
+    }
+}
+
+int write_shape_file(const char* path, const BENCH_SHAPE* shape)
+{
+    // Deterministic between runs and platforms
+    unsigned int state = 2463534242u;
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    for (int r = 0; r < shape->repeat; ++r) {
+        int key_begin = shape->num_keys * r / shape->repeat;
+        int key_end = shape->num_keys * (r + 1) / shape->repeat;
+        for (int s = 0; s < shape->num_sections; ++s) {
+            fprintf(file, "[section%d]\n", s);
+            for (int k = (0 < r) ? key_begin - 1 : key_begin; k < key_end; ++k) {
+                fprintf(file, "key%d = ", (k < key_begin) ? 0 : k);
+                for (int e = 0; e < shape->num_elements; ++e) {
+                    fputs((e == 0) ? "" : ", ", file);
+                    write_value(file, shape->value_type, &state);
+                }
+                fputc('\n', file);
+            }
+        }
+    }
+    fclose(file);
+    return 1;
+}
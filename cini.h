@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 //
 // API for C
 //
@@ -14,16 +17,106 @@ extern "C" {
 #endif
 
 typedef void* HCINI;
+typedef const void* CINI_KEY;
+
+// Allocator for the memory of the handle
+// The 'alloc' returns null if failed, the 'free' is called with the pointer returned by 'alloc'
+typedef struct {
+    void* (*alloc)(void* user_data, size_t size);
+    void (*free)(void* user_data, void* ptr);
+    void* user_data;
+} CINI_ALLOCATOR;
+
+// Thread safety
+// The handle can be read from multiple threads at once after the create function returned
+// The values are converted at the first access under the lock of the handle, see cini_preload to avoid it
+// The cini_free must be called after the all of threads finished using the handle
 
 // Parse ini file and associate it to HCINI handle
 // cini_create - Parse the all of ini file
 // cini_create_with_section - Parse the specified section in ini file, it is faster than cini_create
+// cini_create_with_sections - Parse the specified sections in ini file, the other sections are skipped without parsing
 HCINI cini_create(const char* path);
 HCINI cini_create_with_section(const char* path, const char* section);
+HCINI cini_create_with_sections(const char* path, const char* const* sections, int count);
+
+// Parse ini file with the allocator, the all of memory of the handle is allocated by it and released by cini_free
+// The 'sections' can be null to parse all sections, the 'allocator' is copied and can be null to use CINI_MALLOC/CINI_FREE
+HCINI cini_create_ex(const char* path, const char* const* sections, int count, const CINI_ALLOCATOR* allocator);
+
+// Parse the files in parallel, the handles are stored in 'out_handles' in the order of 'paths'
+// The 'threads' is the number of threads including the calling thread, 0 uses the number of processors
+// The errors of each file are recorded in its handle (see cini_geterror), all of handles must be released by cini_free
+// The function returns the number of handles created (it is less than 'count' only if the memory allocation failed)
+int cini_create_many(const char* const* paths, int count, HCINI* out_handles, int threads);
+
+// Map ini file into memory, split it at the section lines and parse the parts in parallel
+// The result is the same as cini_create_mmap: The duplicate sections are merged and the first entry of the same key is kept
+// The 'threads' is the number of threads including the calling thread, 0 uses the number of processors
+// The file smaller than CINI_PARALLEL_CHUNK_SIZE per thread is parsed by fewer threads
+HCINI cini_create_parallel(const char* path, int threads);
+
+// Map ini file into memory and parse it without copying the names and values
+// The strings are referred from the mapping and copied only when cini_gets/cini_getas is called
+// The 'section' can be null to parse all sections
+HCINI cini_create_mmap(const char* path, const char* section);
+
+// Map ini file into memory and record where each section is, the section is parsed at the first access by the getters
+// Opening costs one scan for the section lines, and only the sections used are parsed
+// The errors of a section are recorded when it is parsed, cini_preload parses the all of sections
+HCINI cini_create_lazy(const char* path);
+
+// Parse ini data on memory
+// The data does not have to be null terminated, and can be released after the function returns
+// The 'section' can be null to parse all sections
+HCINI cini_create_from_buffer(const char* data, size_t len, const char* section);
+
+// Compiled file: The parsed data which can be loaded by mapping it into memory without parsing
+// cini_save_compiled - Write the compiled file, it returns non-zero if succeeded
+//                      The handle created with section filter cannot be saved
+// cini_create_compiled - Load the compiled file, the error is recorded if the source ini file was modified after saving
+HCINI cini_create_compiled(const char* path);
+int cini_save_compiled(HCINI hcini, const char* path);
+
+// Callbacks of cini_parse_events, the null callback is not called
+// The strings are borrowed from the file and are not null terminated, they are valid only while the callback runs
+// The callback returns non-zero to continue or 0 to stop the parse
+// section - The section line, the keys before the first section belong to the default section which has the empty name
+// key - The key line, followed by 'value' and 'element' of the same line
+// value - The whole value, the quotes are removed if 'quoted' is non-zero
+// element - The array elements split by ',', the key without '=' has no element
+// error - The invalid line, 'message' is null terminated
+typedef struct {
+    int (*section)(void* user_data, const char* name, size_t len, int line_no);
+    int (*key)(void* user_data, const char* name, size_t len, int line_no);
+    int (*value)(void* user_data, const char* value, size_t len, int quoted);
+    int (*element)(void* user_data, int index_, const char* value, size_t len, int quoted);
+    int (*error)(void* user_data, const char* message, int line_no);
+} CINI_EVENTS;
+
+// Parse ini file (mapped into memory) or ini data on memory, and call the callbacks in the file order without building the handle
+// Nothing is merged: The duplicate sections and keys are reported as they appear, and the numbers are not converted
+// The function returns non-zero if the parse reached the end, or 0 if the file cannot be opened or a callback stopped it
+int cini_parse_events(const char* path, const CINI_EVENTS* events, void* user_data);
+int cini_parse_events_buffer(const char* data, size_t len, const CINI_EVENTS* events, void* user_data);
 
 // Release resources
 void cini_free(HCINI hcini);
 
+// Convert the all of values in advance
+// The getters never take the lock of the handle after this
+void cini_preload(HCINI hcini);
+
+// Rebuild the parsed data into the flat tables of the compiled file layout and release the parsed nodes
+// The same strings share one copy, the memory mapping is released, and the getters never take the lock after this
+// It must be called before the handle is shared with the other threads, the function returns non-zero if succeeded
+// The keys (cini_lookup), the cursors (cini_section_first...) and the strings (cini_gets...) got before are invalidated
+int cini_compact(HCINI hcini);
+
+// Check the ini file was modified after parsing, the function returns non-zero if it was modified
+// It always returns zero for the handle created from buffer or compiled file
+int cini_ismodified(HCINI hcini);
+
 // Get the value of indicated section and key
 // The function returns default value if could not find the entry or the value type was mismatch
 int cini_geti(HCINI hcini, const char* section, const char* key, int idefault);
@@ -35,13 +128,110 @@ int cini_getai(HCINI hcini, const char* section, const char* key, int index_, in
 float cini_getaf(HCINI hcini, const char* section, const char* key, int index_, float fdefault);
 const char* cini_getas(HCINI hcini, const char* section, const char* key, int index_, const char* sdefault);
 
+// 64-bit integer and double accessors
+// The integer written in decimal or hexadecimal is kept exactly up to 64 bits, the other numbers are truncated like cini_geti
+// cini_getu64 returns the default value for the negative number
+int64_t cini_geti64(HCINI hcini, const char* section, const char* key, int64_t idefault);
+uint64_t cini_getu64(HCINI hcini, const char* section, const char* key, uint64_t udefault);
+double cini_getd(HCINI hcini, const char* section, const char* key, double ddefault);
+int64_t cini_getai64(HCINI hcini, const char* section, const char* key, int index_, int64_t idefault);
+uint64_t cini_getau64(HCINI hcini, const char* section, const char* key, int index_, uint64_t udefault);
+double cini_getad(HCINI hcini, const char* section, const char* key, int index_, double ddefault);
+
 // Get number of array elements
 int cini_getcount(HCINI hcini, const char* section, const char* key);
 
+// Get the array elements from the beginning into 'out' at once
+// The function returns number of elements stored (up to 'max')
+// The element which cannot be got by the type is not stored, so the initial value in 'out' works as default value
+int cini_getai_range(HCINI hcini, const char* section, const char* key, int* out, int max);
+int cini_getaf_range(HCINI hcini, const char* section, const char* key, float* out, int max);
+int cini_getas_range(HCINI hcini, const char* section, const char* key, const char** out, int max);
+
+// Resolve the section and key in advance, the function returns null if could not find the entry
+// The accessors with the key skip the name lookup, the key is valid until the handle is released or compacted
+// cini_compact rebuilds the storage, so the key must be looked up again after it (the key of the compacted handle stays valid)
+CINI_KEY cini_lookup(HCINI hcini, const char* section, const char* key);
+
+// Section and key names with the hashes computed in advance, the names do not have to be null terminated
+// section_hash - FNV-1a 32-bit of the section name
+// entry_hash - FNV-1a 32-bit of the key name which starts from (section_hash * 16777619) instead of the offset basis
+typedef struct {
+    const char* section;
+    size_t section_len;
+    const char* key;
+    size_t key_len;
+    uint32_t section_hash;
+    uint32_t entry_hash;
+} CINI_KEY_DESC;
+
+// Resolve the key without hashing the names
+CINI_KEY cini_lookup_desc(HCINI hcini, const CINI_KEY_DESC* desc);
+int cini_key_geti(HCINI hcini, CINI_KEY key, int idefault);
+float cini_key_getf(HCINI hcini, CINI_KEY key, float fdefault);
+const char* cini_key_gets(HCINI hcini, CINI_KEY key, const char* sdefault);
+int cini_key_getai(HCINI hcini, CINI_KEY key, int index_, int idefault);
+float cini_key_getaf(HCINI hcini, CINI_KEY key, int index_, float fdefault);
+const char* cini_key_getas(HCINI hcini, CINI_KEY key, int index_, const char* sdefault);
+int cini_key_getcount(HCINI hcini, CINI_KEY key);
+int64_t cini_key_geti64(HCINI hcini, CINI_KEY key, int64_t idefault);
+uint64_t cini_key_getu64(HCINI hcini, CINI_KEY key, uint64_t udefault);
+double cini_key_getd(HCINI hcini, CINI_KEY key, double ddefault);
+int64_t cini_key_getai64(HCINI hcini, CINI_KEY key, int index_, int64_t idefault);
+uint64_t cini_key_getau64(HCINI hcini, CINI_KEY key, int index_, uint64_t udefault);
+double cini_key_getad(HCINI hcini, CINI_KEY key, int index_, double ddefault);
+
+// Walk the sections and the entries in the file order without the name lookup, the function returns null at the end
+// The default section has the empty name, and the sections skipped by the filter are not included
+// The entry is the key for the accessors above, the cursors and the names are valid until the handle is released or compacted
+typedef const void* CINI_SECTION;
+CINI_SECTION cini_section_first(HCINI hcini);
+CINI_SECTION cini_section_next(HCINI hcini, CINI_SECTION section);
+const char* cini_section_name(HCINI hcini, CINI_SECTION section);
+CINI_KEY cini_entry_first(HCINI hcini, CINI_SECTION section);
+CINI_KEY cini_entry_next(HCINI hcini, CINI_KEY entry);
+const char* cini_entry_name(HCINI hcini, CINI_KEY entry);
+
 // Get error information which recorded when parsing ini file
 int cini_geterrorcount(HCINI hcini);
 const char* cini_geterror(HCINI hcini, int index_);
 
+// The section and key names are interned while parsing (except cini_create_mmap/cini_create_parallel/cini_create_lazy)
+// The same names share one copy, so the names got from the handle can be compared by pointer
+// cini_intern returns the shared copy of the name 'str', or null if the handle does not have it (or the handle was compacted)
+// CINI_NO_INTERN disables interning, the values are deduplicated by cini_compact
+const char* cini_intern(HCINI hcini, const char* str);
+
+// Statistics of the handle, the counters are accumulated since the handle was created
+// The times are in nanoseconds of the wall clock: 'io_ns' is opening and reading (or mapping) the file, 'tokenize_ns' is the rest of the parse
+// The numbers are converted at the first access, so 'number_count' and 'number_ns' grow while the values are got
+// The getters are not timed nor counted by default, 'number_ns' and the lookup counters stay 0 unless CINI_STATS_LOOKUP is defined with CINI_IMPLEMENTATION
+typedef struct {
+    size_t memory_bytes;       // Bytes allocated for the handle
+    size_t interned_count;     // Number of distinct interned names
+    size_t shared_count;       // Number of names which shared the interned copy
+    size_t saved_bytes;        // Bytes not copied by sharing
+    size_t bytes_read;         // Bytes of the source parsed
+    size_t line_count;         // Lines of the source, including the lines skipped for the other sections
+    size_t section_count;      // Sections created
+    size_t entry_count;        // Entries created
+    size_t value_count;        // Values created, the whole value of each entry and the array elements split so far
+    size_t chunk_count;        // Memory chunks and dedicated blocks allocated
+    size_t wasted_bytes;       // Bytes lost to the alignment and to the tails left in the chunks
+    size_t index_bytes;        // Bytes of the hash index slots held, included in memory_bytes
+    size_t released_bytes;     // Bytes released while parsing (the old slots of the grown indexes), not in memory_bytes
+    uint64_t io_ns;
+    uint64_t tokenize_ns;
+    uint64_t number_ns;
+    size_t number_count;       // Values converted to the number
+    uint64_t lookup_count;     // Lookups by the getters and cini_lookup
+    uint64_t lookup_hit_count; // Lookups which found the key
+    uint64_t probe_count;      // Slots visited by the lookups, divide by lookup_count for the average probe length
+} CINI_STATS;
+
+// Get the statistics, the function returns non-zero if succeeded
+int cini_getstats(HCINI hcini, CINI_STATS* stats);
+
 #if defined(__cplusplus)
 } // extern "C"
 #endif
@@ -52,13 +242,118 @@ const char* cini_geterror(HCINI hcini, int index_);
 // API for C++
 //
 
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define CINI_HAS_CPP17 1
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#else
+#define CINI_HAS_CPP17 0
+#endif
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+// CiniLive needs the threads, so it is defined only if CINI_LIVE is defined before including cini.h
+#if defined(CINI_LIVE)
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#if CINI_HAS_CPP17
+// Specialize it with the tuple of Cini::field to bind the struct, see Cini::bind
+template <typename S>
+struct CiniSchema;
+#endif
+
 class Cini {
 public:
+    // Flags for constructor
+    // MMAP - Parse with memory mapped file, see cini_create_mmap
+    // COMPILED - Load the compiled file, see cini_create_compiled
+    // PARALLEL - Parse with multiple threads, see cini_create_parallel, the 'section' filter uses MMAP instead
+    // COMPACT - Rebuild into the flat tables after parsing, see cini_compact
+    // LAZY - Parse each section at the first access, see cini_create_lazy, the 'section' filter uses MMAP instead
+    enum {
+        MMAP = 0x01,
+        COMPILED = 0x02,
+        PARALLEL = 0x04,
+        COMPACT = 0x08,
+        LAZY = 0x10,
+    };
+
     // Parse ini file and associate it to Cini instance
     // If the 'section' is not null, the cini parse specific section only
-    Cini(const char* path, const char* section = nullptr) { hcini_ = cini_create_with_section(path, section); }
+    Cini(const char* path, const char* section = nullptr, int flags = 0)
+    {
+        if (flags & COMPILED) {
+            hcini_ = cini_create_compiled(path);
+        } else if ((flags & PARALLEL) && section == nullptr) {
+            hcini_ = cini_create_parallel(path, 0);
+        } else if ((flags & LAZY) && section == nullptr) {
+            hcini_ = cini_create_lazy(path);
+        } else if (flags & (PARALLEL | LAZY)) {
+            hcini_ = cini_create_mmap(path, section);
+        } else {
+            hcini_ = (flags & MMAP) ? cini_create_mmap(path, section) : cini_create_with_section(path, section);
+        }
+        if (flags & COMPACT) {
+            cini_compact(hcini_);
+        }
+    }
+    // Parse the specified sections only
+    Cini(const char* path, std::initializer_list<const char*> sections) { hcini_ = cini_create_with_sections(path, sections.begin(), (int)sections.size()); }
+    // Parse with the allocator, see cini_create_ex
+    Cini(const char* path, const CINI_ALLOCATOR& allocator, const char* section = nullptr) { hcini_ = cini_create_ex(path, (section != nullptr) ? &section : nullptr, (section != nullptr) ? 1 : 0, &allocator); }
     ~Cini() { cini_free(hcini_); }
 
+#if CINI_HAS_CPP17
+    // Parse ini data on memory, it is named so that the data is not mistaken for the path of the constructors
+    static Cini from_buffer(std::string_view data, const char* section = nullptr) { return Cini(cini_create_from_buffer(data.data(), data.size(), section), Adopt()); }
+#endif
+
+    // Parse the files in parallel, see cini_create_many
+    static std::vector<std::unique_ptr<Cini>> create_many(const std::vector<std::string>& paths, int threads = 0)
+    {
+        std::vector<const char*> path_list;
+        std::vector<HCINI> handles(paths.size(), nullptr);
+        std::vector<std::unique_ptr<Cini>> cinis;
+        for (const std::string& path : paths) {
+            path_list.push_back(path.c_str());
+        }
+        cini_create_many(path_list.data(), (int)path_list.size(), handles.data(), threads);
+        for (HCINI hcini : handles) {
+            cinis.emplace_back(new Cini(hcini, Adopt()));
+        }
+        return cinis;
+    }
+
+    // Resolved section and key, see cini_lookup, it is invalidated by cini_compact
+    class Key {
+    public:
+        Key()
+            : key_(nullptr)
+        {
+        }
+        explicit operator bool() const { return key_ != nullptr; }
+
+    private:
+        friend class Cini;
+        explicit Key(CINI_KEY key)
+            : key_(key)
+        {
+        }
+        CINI_KEY key_;
+    };
+
+    // Write the compiled file
+    bool save_compiled(const char* path) const { return cini_save_compiled(hcini_, path) != 0; }
+
     // Get the value of indicated section and key
     // The function returns default value if could not find the entry or the value type was mismatch
     int geti(const char* section, const char* key, int idefault = 0) const { return cini_geti(hcini_, section, key, idefault); }
@@ -70,41 +365,456 @@ public:
     float getaf(const char* section, const char* key, int index_, float fdefault = 0.0F) const { return cini_getaf(hcini_, section, key, index_, fdefault); }
     const char* getas(const char* section, const char* key, int index_, const char* sdefault = "") const { return cini_getas(hcini_, section, key, index_, sdefault); }
 
+    // 64-bit integer and double accessors
+    int64_t geti64(const char* section, const char* key, int64_t idefault = 0) const { return cini_geti64(hcini_, section, key, idefault); }
+    uint64_t getu64(const char* section, const char* key, uint64_t udefault = 0) const { return cini_getu64(hcini_, section, key, udefault); }
+    double getd(const char* section, const char* key, double ddefault = 0.0) const { return cini_getd(hcini_, section, key, ddefault); }
+    int64_t getai64(const char* section, const char* key, int index_, int64_t idefault = 0) const { return cini_getai64(hcini_, section, key, index_, idefault); }
+    uint64_t getau64(const char* section, const char* key, int index_, uint64_t udefault = 0) const { return cini_getau64(hcini_, section, key, index_, udefault); }
+    double getad(const char* section, const char* key, int index_, double ddefault = 0.0) const { return cini_getad(hcini_, section, key, index_, ddefault); }
+
     // Get number of array elements
     int getcount(const char* section, const char* key) const { return cini_getcount(hcini_, section, key); }
 
+    // Get the array elements from the beginning into 'out' at once
+    int getai_range(const char* section, const char* key, int* out, int max) const { return cini_getai_range(hcini_, section, key, out, max); }
+    int getaf_range(const char* section, const char* key, float* out, int max) const { return cini_getaf_range(hcini_, section, key, out, max); }
+    int getas_range(const char* section, const char* key, const char** out, int max) const { return cini_getas_range(hcini_, section, key, out, max); }
+
+    // Resolve the section and key in advance, and get the value without the name lookup
+    Key lookup(const char* section, const char* key) const { return Key(cini_lookup(hcini_, section, key)); }
+    int geti(Key key, int idefault = 0) const { return cini_key_geti(hcini_, key.key_, idefault); }
+    float getf(Key key, float fdefault = 0.0F) const { return cini_key_getf(hcini_, key.key_, fdefault); }
+    const char* gets(Key key, const char* sdefault = "") const { return cini_key_gets(hcini_, key.key_, sdefault); }
+    int getai(Key key, int index_, int idefault = 0) const { return cini_key_getai(hcini_, key.key_, index_, idefault); }
+    float getaf(Key key, int index_, float fdefault = 0.0F) const { return cini_key_getaf(hcini_, key.key_, index_, fdefault); }
+    const char* getas(Key key, int index_, const char* sdefault = "") const { return cini_key_getas(hcini_, key.key_, index_, sdefault); }
+    int getcount(Key key) const { return cini_key_getcount(hcini_, key.key_); }
+    int64_t geti64(Key key, int64_t idefault = 0) const { return cini_key_geti64(hcini_, key.key_, idefault); }
+    uint64_t getu64(Key key, uint64_t udefault = 0) const { return cini_key_getu64(hcini_, key.key_, udefault); }
+    double getd(Key key, double ddefault = 0.0) const { return cini_key_getd(hcini_, key.key_, ddefault); }
+    int64_t getai64(Key key, int index_, int64_t idefault = 0) const { return cini_key_getai64(hcini_, key.key_, index_, idefault); }
+    uint64_t getau64(Key key, int index_, uint64_t udefault = 0) const { return cini_key_getau64(hcini_, key.key_, index_, udefault); }
+    double getad(Key key, int index_, double ddefault = 0.0) const { return cini_key_getad(hcini_, key.key_, index_, ddefault); }
+
+#if CINI_HAS_CPP17
+    // Make the key descriptor at compile time, the hashes are the same as cini.h computes at runtime
+    static constexpr uint32_t hash(uint32_t h, std::string_view s)
+    {
+        for (char c : s) {
+            h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return h;
+    }
+    static constexpr CINI_KEY_DESC desc(std::string_view section, std::string_view key)
+    {
+        uint32_t section_hash = hash(2166136261u, section);
+        return CINI_KEY_DESC { section.data(), section.size(), key.data(), key.size(), section_hash, hash(section_hash * 16777619u, key) };
+    }
+    Key lookup(const CINI_KEY_DESC& key_desc) const { return Key(cini_lookup_desc(hcini_, &key_desc)); }
+
+    // Typed field of the struct, the member is int, int64_t, uint64_t, float, double, bool, const char* or std::string
+    // The const char* member refers to the string in the handle, the std::string member has const char* default value
+    template <typename S, typename T>
+    struct Field {
+        using default_type = std::conditional_t<std::is_same_v<T, std::string>, const char*, T>;
+        CINI_KEY_DESC key_desc;
+        T S::*member;
+        default_type default_value;
+    };
+    template <typename S, typename T, typename D>
+    static constexpr Field<S, T> field(std::string_view section, std::string_view key, T S::*member, D default_value)
+    {
+        return Field<S, T> { desc(section, key), member, static_cast<typename Field<S, T>::default_type>(default_value) };
+    }
+
+    // Set the all of fields listed in CiniSchema<S>::fields, the missing entries get the default values
+    template <typename S>
+    void bind(S& out) const { bind(out, CiniSchema<S>::fields); }
+    template <typename S>
+    S bind() const
+    {
+        S out {};
+        bind(out);
+        return out;
+    }
+    template <typename S, typename... Fields>
+    void bind(S& out, const std::tuple<Fields...>& fields) const
+    {
+        std::apply([this, &out](const auto&... fields_) { (assign(out, fields_), ...); }, fields);
+    }
+#endif
+
     // Get error information which recorded when parsing ini file
     int geterrorcount() const { return cini_geterrorcount(hcini_); }
     const char* geterror(int index_) const { return cini_geterror(hcini_, index_); }
 
+    // Interned name and statistics, see cini_intern and cini_getstats
+    const char* intern(const char* str) const { return cini_intern(hcini_, str); }
+    CINI_STATS getstats() const
+    {
+        CINI_STATS stats {};
+        cini_getstats(hcini_, &stats);
+        return stats;
+    }
+
+    // Walk the sections and the entries in the file order, see cini_section_first
+    // for (Cini::Section section : cini) { for (Cini::Entry entry : section) { ... } }
+    template <typename T>
+    class Iterator {
+    public:
+        Iterator(HCINI hcini, const void* cursor)
+            : hcini_(hcini)
+            , cursor_(cursor)
+        {
+        }
+        T operator*() const { return T(hcini_, cursor_); }
+        Iterator& operator++()
+        {
+            cursor_ = T::next(hcini_, cursor_);
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return cursor_ == other.cursor_; }
+        bool operator!=(const Iterator& other) const { return cursor_ != other.cursor_; }
+
+    private:
+        HCINI hcini_;
+        const void* cursor_;
+    };
+
+    class Entry {
+    public:
+        const char* name() const { return cini_entry_name(hcini_, key_); }
+        Key key() const { return Key(key_); }
+        int geti(int idefault = 0) const { return cini_key_geti(hcini_, key_, idefault); }
+        float getf(float fdefault = 0.0F) const { return cini_key_getf(hcini_, key_, fdefault); }
+        const char* gets(const char* sdefault = "") const { return cini_key_gets(hcini_, key_, sdefault); }
+        int getai(int index_, int idefault = 0) const { return cini_key_getai(hcini_, key_, index_, idefault); }
+        float getaf(int index_, float fdefault = 0.0F) const { return cini_key_getaf(hcini_, key_, index_, fdefault); }
+        const char* getas(int index_, const char* sdefault = "") const { return cini_key_getas(hcini_, key_, index_, sdefault); }
+        int getcount() const { return cini_key_getcount(hcini_, key_); }
+
+    private:
+        friend class Iterator<Entry>;
+        Entry(HCINI hcini, CINI_KEY key)
+            : hcini_(hcini)
+            , key_(key)
+        {
+        }
+        static CINI_KEY next(HCINI hcini, CINI_KEY key) { return cini_entry_next(hcini, key); }
+        HCINI hcini_;
+        CINI_KEY key_;
+    };
+
+    class Section {
+    public:
+        const char* name() const { return cini_section_name(hcini_, section_); }
+        Iterator<Entry> begin() const { return Iterator<Entry>(hcini_, cini_entry_first(hcini_, section_)); }
+        Iterator<Entry> end() const { return Iterator<Entry>(hcini_, nullptr); }
+
+    private:
+        friend class Iterator<Section>;
+        Section(HCINI hcini, CINI_SECTION section)
+            : hcini_(hcini)
+            , section_(section)
+        {
+        }
+        static CINI_SECTION next(HCINI hcini, CINI_SECTION section) { return cini_section_next(hcini, section); }
+        HCINI hcini_;
+        CINI_SECTION section_;
+    };
+
+    Iterator<Section> begin() const { return Iterator<Section>(hcini_, cini_section_first(hcini_)); }
+    Iterator<Section> end() const { return Iterator<Section>(hcini_, nullptr); }
+
 private:
     HCINI hcini_;
 
+    struct Adopt { };
+    Cini(HCINI hcini, Adopt)
+        : hcini_(hcini)
+    {
+    }
+
+#if CINI_HAS_CPP17
+    template <typename S, typename T>
+    void assign(S& out, const Field<S, T>& field_) const
+    {
+        auto value = read(cini_lookup_desc(hcini_, &field_.key_desc), field_.default_value);
+        if constexpr (std::is_same_v<T, std::string>) {
+            out.*(field_.member) = (value != nullptr) ? value : "";
+        } else {
+            out.*(field_.member) = value;
+        }
+    }
+    int read(CINI_KEY key, int idefault) const { return cini_key_geti(hcini_, key, idefault); }
+    float read(CINI_KEY key, float fdefault) const { return cini_key_getf(hcini_, key, fdefault); }
+    int64_t read(CINI_KEY key, int64_t idefault) const { return cini_key_geti64(hcini_, key, idefault); }
+    uint64_t read(CINI_KEY key, uint64_t udefault) const { return cini_key_getu64(hcini_, key, udefault); }
+    double read(CINI_KEY key, double ddefault) const { return cini_key_getd(hcini_, key, ddefault); }
+    bool read(CINI_KEY key, bool bdefault) const { return cini_key_geti(hcini_, key, bdefault ? 1 : 0) != 0; }
+    const char* read(CINI_KEY key, const char* sdefault) const { return cini_key_gets(hcini_, key, sdefault); }
+#endif
+
     // Non-copiable
     Cini(const Cini&);
     Cini& operator=(const Cini&);
 };
 
+#if defined(CINI_LIVE)
+// Reloadable ini file for multi-threaded program
+// The background thread checks the modification of the file at the interval, and parses it again if modified
+// The readers never block, the old data is released after the all of readers referring it have left
+class CiniLive {
+public:
+    // Consistent view of the data, the strings got from it are valid until the snapshot is destroyed
+    class Snapshot {
+    public:
+        explicit Snapshot(const CiniLive& live)
+            : live_(&live)
+            , parity_(live.enter())
+            , hcini_(live.current_.load())
+        {
+        }
+        Snapshot(Snapshot&& other)
+            : live_(other.live_)
+            , parity_(other.parity_)
+            , hcini_(other.hcini_)
+        {
+            other.live_ = nullptr;
+        }
+        ~Snapshot()
+        {
+            if (live_ != nullptr) {
+                live_->leave(parity_);
+            }
+        }
+
+        int geti(const char* section, const char* key, int idefault = 0) const { return cini_geti(hcini_, section, key, idefault); }
+        float getf(const char* section, const char* key, float fdefault = 0.0F) const { return cini_getf(hcini_, section, key, fdefault); }
+        const char* gets(const char* section, const char* key, const char* sdefault = "") const { return cini_gets(hcini_, section, key, sdefault); }
+        int getai(const char* section, const char* key, int index_, int idefault = 0) const { return cini_getai(hcini_, section, key, index_, idefault); }
+        float getaf(const char* section, const char* key, int index_, float fdefault = 0.0F) const { return cini_getaf(hcini_, section, key, index_, fdefault); }
+        const char* getas(const char* section, const char* key, int index_, const char* sdefault = "") const { return cini_getas(hcini_, section, key, index_, sdefault); }
+        int64_t geti64(const char* section, const char* key, int64_t idefault = 0) const { return cini_geti64(hcini_, section, key, idefault); }
+        uint64_t getu64(const char* section, const char* key, uint64_t udefault = 0) const { return cini_getu64(hcini_, section, key, udefault); }
+        double getd(const char* section, const char* key, double ddefault = 0.0) const { return cini_getd(hcini_, section, key, ddefault); }
+        int getcount(const char* section, const char* key) const { return cini_getcount(hcini_, section, key); }
+        int getai_range(const char* section, const char* key, int* out, int max) const { return cini_getai_range(hcini_, section, key, out, max); }
+        int getaf_range(const char* section, const char* key, float* out, int max) const { return cini_getaf_range(hcini_, section, key, out, max); }
+        int getas_range(const char* section, const char* key, const char** out, int max) const { return cini_getas_range(hcini_, section, key, out, max); }
+        int geterrorcount() const { return cini_geterrorcount(hcini_); }
+        const char* geterror(int index_) const { return cini_geterror(hcini_, index_); }
+
+    private:
+        const CiniLive* live_;
+        unsigned parity_;
+        HCINI hcini_;
+
+        // Non-copiable
+        Snapshot(const Snapshot&);
+        Snapshot& operator=(const Snapshot&);
+    };
+
+    // Parse ini file and start watching it, the 'flags' accepts Cini::MMAP and Cini::COMPACT
+    // The file is not watched if the 'interval_ms' is 0, call reload to parse it again
+    CiniLive(const char* path, const char* section = nullptr, int flags = 0, int interval_ms = 1000)
+        : path_(path)
+        , section_((section != nullptr) ? section : "")
+        , has_section_(section != nullptr)
+        , flags_(flags)
+        , epoch_(0)
+        , generation_(0)
+        , stop_(false)
+    {
+        readers_[0].store(0);
+        readers_[1].store(0);
+        current_.store(create());
+        if (0 < interval_ms) {
+            watcher_ = std::thread(&CiniLive::watch, this, interval_ms);
+        }
+    }
+    ~CiniLive()
+    {
+        {
+            std::lock_guard<std::mutex> lock(watch_mutex_);
+            stop_ = true;
+        }
+        watch_cond_.notify_all();
+        if (watcher_.joinable()) {
+            watcher_.join();
+        }
+        cini_free(current_.load());
+    }
+
+    // Parse the file again and replace the data
+    void reload()
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex_);
+        publish(create());
+    }
+
+    // Number of times the data was replaced
+    unsigned generation() const { return generation_.load(); }
+
+    // Get the consistent view to get several values from the same data
+    Snapshot snapshot() const { return Snapshot(*this); }
+
+    // Get the value from the current data, the strings are copied because the data can be replaced after returning
+    int geti(const char* section, const char* key, int idefault = 0) const { return Snapshot(*this).geti(section, key, idefault); }
+    float getf(const char* section, const char* key, float fdefault = 0.0F) const { return Snapshot(*this).getf(section, key, fdefault); }
+    std::string gets(const char* section, const char* key, const char* sdefault = "") const { return Snapshot(*this).gets(section, key, sdefault); }
+    int getai(const char* section, const char* key, int index_, int idefault = 0) const { return Snapshot(*this).getai(section, key, index_, idefault); }
+    float getaf(const char* section, const char* key, int index_, float fdefault = 0.0F) const { return Snapshot(*this).getaf(section, key, index_, fdefault); }
+    std::string getas(const char* section, const char* key, int index_, const char* sdefault = "") const { return Snapshot(*this).getas(section, key, index_, sdefault); }
+    int64_t geti64(const char* section, const char* key, int64_t idefault = 0) const { return Snapshot(*this).geti64(section, key, idefault); }
+    uint64_t getu64(const char* section, const char* key, uint64_t udefault = 0) const { return Snapshot(*this).getu64(section, key, udefault); }
+    double getd(const char* section, const char* key, double ddefault = 0.0) const { return Snapshot(*this).getd(section, key, ddefault); }
+    int getcount(const char* section, const char* key) const { return Snapshot(*this).getcount(section, key); }
+    int geterrorcount() const { return Snapshot(*this).geterrorcount(); }
+
+private:
+    std::string path_;
+    std::string section_;
+    bool has_section_;
+    int flags_;
+    std::atomic<HCINI> current_;
+    mutable std::atomic<unsigned> epoch_;
+    mutable std::atomic<unsigned> readers_[2];
+    std::atomic<unsigned> generation_;
+    std::mutex reload_mutex_;
+    std::mutex watch_mutex_;
+    std::condition_variable watch_cond_;
+    bool stop_;
+    std::thread watcher_;
+
+    HCINI create() const
+    {
+        // The readers never take the lock of the preloaded handle
+        const char* section = has_section_ ? section_.c_str() : nullptr;
+        HCINI hcini = (flags_ & Cini::MMAP) ? cini_create_mmap(path_.c_str(), section) : cini_create_with_section(path_.c_str(), section);
+        if (!((flags_ & Cini::COMPACT) && cini_compact(hcini))) {
+            cini_preload(hcini);
+        }
+        return hcini;
+    }
+
+    unsigned enter() const
+    {
+        // Count up the reader on the current epoch before loading the data
+        unsigned parity = epoch_.load() & 1;
+        readers_[parity].fetch_add(1);
+        return parity;
+    }
+
+    void leave(unsigned parity) const { readers_[parity].fetch_sub(1); }
+
+    void publish(HCINI hcini)
+    {
+        // Any reader referring to the old data has counted up before the exchange
+        // Advance the epoch and wait each counter to be 0 once, then no reader refers to the old data
+        // The new readers count up the other counter, so the writer is not kept waiting by them
+        HCINI old = current_.exchange(hcini);
+        generation_.fetch_add(1);
+        for (int i = 0; i < 2; ++i) {
+            unsigned parity = epoch_.fetch_add(1) & 1;
+            while (readers_[parity].load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+        cini_free(old);
+    }
+
+    void watch(int interval_ms)
+    {
+        std::unique_lock<std::mutex> lock(watch_mutex_);
+        while (!watch_cond_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return stop_; })) {
+            lock.unlock();
+            {
+                // Check under the lock because reload may release the current data
+                std::lock_guard<std::mutex> reload_lock(reload_mutex_);
+                if (cini_ismodified(current_.load())) {
+                    publish(create());
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    // Non-copiable
+    CiniLive(const CiniLive&);
+    CiniLive& operator=(const CiniLive&);
+};
+#endif // CINI_LIVE
+
 #endif // __cplusplus
 
 #if defined(CINI_IMPLEMENTATION)
 
 #include <assert.h>
-#include <ctype.h>
 #include <errno.h>
 #include <float.h>
+#include <locale.h>
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// The POSIX.1-2008 functions and fields are hidden in the strict ISO mode (e.g. -std=c99) of glibc
+#if (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L) || (defined(_XOPEN_SOURCE) && _XOPEN_SOURCE >= 700)
+#define CINI_IN_POSIX_2008
+#endif
+
+// SSE2 is the baseline of x64, AVX2 is selected at runtime, CINI_NO_SIMD uses the scalar scanner only
+#if !defined(CINI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CINI_IN_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CINI_IN_TARGET_AVX2
+#else
+#define CINI_IN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 #ifndef CINI_MEMORY_CHUNK_SIZE
 #define CINI_MEMORY_CHUNK_SIZE 2048
 #endif
 
-#ifndef CINI_LINE_BUFFER_SIZE
-#define CINI_LINE_BUFFER_SIZE 512
+#ifndef CINI_MEMORY_CHUNK_SIZE_MAX
+#define CINI_MEMORY_CHUNK_SIZE_MAX 65536
+#endif
+
+#ifndef CINI_READ_BUFFER_SIZE
+#define CINI_READ_BUFFER_SIZE 65536
+#endif
+
+#ifndef CINI_PARALLEL_CHUNK_SIZE
+#define CINI_PARALLEL_CHUNK_SIZE 1048576
+#endif
+
+#if defined(CINI_NO_INTERN)
+#define CINI_IN_INTERN 0
+#else
+#define CINI_IN_INTERN 1
+#endif
+
+#if defined(CINI_STATS_LOOKUP)
+#define CINI_IN_STATS_LOOKUP 1
+#else
+#define CINI_IN_STATS_LOOKUP 0
 #endif
 
 #ifndef CINI_MALLOC
@@ -116,12 +826,63 @@ private:
 #endif
 
 #define CINI_IN_ERROR_BUFFER_SIZE     128
+#define CINI_IN_NUMBER_BUFFER_SIZE    128
 #define CINI_IN_QUOTE_CHARS           "'\""
 #define CINI_IN_COMMENT_CHARS         ";#"
 #define CINI_IN_ASSIGNMENT_CHARS      "=:"
 #define CINI_IN_ARRAY_SEPARATOR       ','
 #define CINI_IN_SECTION_BRACKET_OPEN  '['
 #define CINI_IN_SECTION_BRACKET_CLOSE ']'
+#define CINI_IN_MEMORY_ALIGNMENT      sizeof(double)
+#define CINI_IN_HASH_OFFSET_BASIS     2166136261u
+#define CINI_IN_HASH_PRIME            16777619u
+#define CINI_IN_INDEX_INITIAL_BITS    4
+#define CINI_IN_VALUE_QUOTED          0x01
+#define CINI_IN_VALUE_CONVERTED       0x02
+#define CINI_IN_WHOLE_VALUE           (-1)
+#define CINI_IN_NUMBER_INTEGER        0x01
+#define CINI_IN_NUMBER_UNSIGNED       0x02
+#define CINI_IN_HASH64_OFFSET_BASIS   14695981039346656037ull
+#define CINI_IN_HASH64_PRIME          1099511628211ull
+#define CINI_IN_IMAGE_MAGIC           "CINI"
+#define CINI_IN_IMAGE_VERSION         2u
+#define CINI_IN_IMAGE_BYTE_ORDER      0x01020304u
+#define CINI_IN_SCAN_SSE2             1
+#define CINI_IN_SCAN_AVX2             2
+
+// The fast path of decimal numbers needs the double arithmetic without the extended precision (x87 rounds twice)
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+#define CINI_IN_FAST_FLOAT 0
+#else
+#define CINI_IN_FAST_FLOAT 1
+#endif
+
+#if defined(_WIN32)
+typedef SRWLOCK CINI_IN_LOCK;
+typedef HANDLE CINI_IN_THREAD;
+#else
+typedef pthread_mutex_t CINI_IN_LOCK;
+typedef pthread_t CINI_IN_THREAD;
+#endif
+
+// Publish the lazy values to the other threads, the value is written before the release store
+#if defined(_MSC_VER)
+#define CINI_IN_LOAD_INT(ptr)         InterlockedCompareExchange((volatile LONG*)(ptr), 0, 0)
+#define CINI_IN_STORE_INT(ptr, value) InterlockedExchange((volatile LONG*)(ptr), (LONG)(value))
+#define CINI_IN_LOAD_PTR(ptr)         InterlockedCompareExchangePointer((PVOID volatile*)(ptr), NULL, NULL)
+#define CINI_IN_STORE_PTR(ptr, value) InterlockedExchangePointer((PVOID volatile*)(ptr), (PVOID)(value))
+#define CINI_IN_FETCH_ADD_INT(ptr, value) InterlockedExchangeAdd((volatile LONG*)(ptr), (LONG)(value))
+#define CINI_IN_LOAD_INT64(ptr)       InterlockedCompareExchange64((volatile LONG64*)(ptr), 0, 0)
+#define CINI_IN_FETCH_ADD_INT64(ptr, value) InterlockedExchangeAdd64((volatile LONG64*)(ptr), (LONG64)(value))
+#else
+#define CINI_IN_LOAD_INT(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define CINI_IN_STORE_INT(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define CINI_IN_LOAD_PTR(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define CINI_IN_STORE_PTR(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define CINI_IN_FETCH_ADD_INT(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#define CINI_IN_LOAD_INT64(ptr)       __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define CINI_IN_FETCH_ADD_INT64(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#endif
 
 typedef struct {
     const char* begin;
@@ -134,8 +895,8 @@ typedef struct CINI_IN_LIST_NODE_ {
 
 typedef struct {
     CINI_IN_LIST_NODE node;
-    char chunk[CINI_MEMORY_CHUNK_SIZE];
     char* ptr;
+    char* end;
 } CINI_IN_MEMORY;
 
 typedef struct {
@@ -149,36 +910,251 @@ typedef struct {
 } CINI_IN_LIST;
 
 typedef struct {
-    CINI_IN_LIST_NODE node;
+    CINI_IN_LIST list;
+    CINI_ALLOCATOR allocator;
+    size_t chunk_size;   // The capacity of the next chunk
+    size_t allocated;    // The bytes of the blocks in the list
+    size_t chunk_count;  // The number of the blocks allocated so far
+    size_t wasted_bytes; // The alignment padding and the tails of the chunks which were not filled
+    size_t released_bytes; // The blocks released by cini_in_release before the handle is released
+} CINI_IN_ARENA;
+
+typedef struct {
+    CINI_IN_LIST_NODE node; // Not linked, only the string index refers to it
+    size_t len;             // The null terminated string follows
+} CINI_IN_INTERNED;
+
+// Number in the value: 'f' is NAN if not numeric
+// The integer written in the ini file is also kept in 'i' exactly (two's complement for the negative number)
+typedef struct {
     double f;
+    uint64_t i;
+    int flags;
+} CINI_IN_NUMBER;
+
+typedef struct {
+    CINI_IN_NUMBER number;
+    CINI_IN_STRING view;
     const char* s;
+    int flags;
 } CINI_IN_VALUE;
 
+struct CINI_IN_SECTION_;
+
 typedef struct {
     CINI_IN_LIST_NODE node;
-    CINI_IN_LIST value_list;
-    const char* name;
+    CINI_IN_VALUE value;
+    CINI_IN_STRING raw;
+    CINI_IN_VALUE* array;
+    int array_count;
+    int array_split;
+    const struct CINI_IN_SECTION_* section;
+    CINI_IN_STRING name;
+    const char* s; // Null terminated name for the iteration, made at the first access in zero-copy mode
 } CINI_IN_ENTRY;
 
 typedef struct {
+    uint32_t hash;
+    CINI_IN_LIST_NODE* node;
+} CINI_IN_INDEX_SLOT;
+
+typedef struct {
+    CINI_IN_INDEX_SLOT* slots;
+    size_t count;
+    int bits;
+} CINI_IN_INDEX;
+
+// Lines of a section in the file for cini_create_lazy, from the section line to the next section line
+typedef struct CINI_IN_RANGE_ {
+    CINI_IN_LIST_NODE node;     // In the file order
+    struct CINI_IN_RANGE_* next; // The next range of the same section
+    const char* begin;
+    const char* end;
+    int line_no; // The number of lines before 'begin', -1 until counted
+} CINI_IN_RANGE;
+
+typedef struct CINI_IN_SECTION_ {
     CINI_IN_LIST_NODE node;
     CINI_IN_LIST entry_list;
-    const char* name;
+    CINI_IN_STRING name;
+    const char* s; // Same as CINI_IN_ENTRY
+    // The lazy section has its own index, so parsing it does not rehash the index which the other threads are reading
+    CINI_IN_INDEX entry_index;
+    CINI_IN_RANGE* range_front;
+    CINI_IN_RANGE* range_back;
+    int parsed;
 } CINI_IN_SECTION;
 
 typedef struct {
-    const char* target_section_name;
-    CINI_IN_LIST memory_list;
+    const CINI_IN_SECTION* section;
+    CINI_IN_STRING name;
+} CINI_IN_ENTRY_KEY;
+
+typedef struct {
+    const char* data;
+    size_t size;
+} CINI_IN_MAPPING;
+
+// Compiled file: The header is followed by the tables in the order of the members, each table is aligned to 8 bytes
+// The offsets are from the beginning of the file, and the strings in the pool are null terminated
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t size;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t source_hash;
+    uint32_t source_path;
+    uint32_t section_count;
+    uint32_t sections;
+    uint32_t entry_count;
+    uint32_t entries;
+    uint32_t value_count;
+    uint32_t values;
+    uint32_t section_index_bits;
+    uint32_t section_index;
+    uint32_t entry_index_bits;
+    uint32_t entry_index;
+    uint32_t error_count;
+    uint32_t errors;
+    uint32_t strings;
+    uint32_t strings_size;
+    uint32_t reserved;
+} CINI_IN_IMAGE_HEADER;
+
+typedef struct {
+    uint32_t name;
+    uint32_t name_len;
+    uint32_t entries;
+    uint32_t entry_count;
+} CINI_IN_IMAGE_SECTION;
+
+typedef struct {
+    double f;
+    uint64_t i;
+    uint32_t s;
+    uint32_t number_flags;
+} CINI_IN_IMAGE_VALUE;
+
+typedef struct {
+    CINI_IN_IMAGE_VALUE value;
+    uint32_t name;
+    uint32_t name_len;
+    uint32_t section;
+    uint32_t elements;
+    uint32_t element_count;
+    uint32_t reserved;
+} CINI_IN_IMAGE_ENTRY;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t index; // Index of the record + 1, 0 is empty
+} CINI_IN_IMAGE_SLOT;
+
+typedef struct {
+    uint32_t section;
+    CINI_IN_STRING name;
+} CINI_IN_IMAGE_ENTRY_KEY;
+
+typedef struct {
+    const char* base;
+    const CINI_IN_IMAGE_HEADER* header;
+    const CINI_IN_IMAGE_SECTION* sections;
+    const CINI_IN_IMAGE_ENTRY* entries;
+    const CINI_IN_IMAGE_VALUE* values;
+    const CINI_IN_IMAGE_SLOT* section_slots;
+    const CINI_IN_IMAGE_SLOT* entry_slots;
+    const uint32_t* errors;
+} CINI_IN_IMAGE;
+
+// Counters for CINI_STATS, they are updated while parsing or under the lock except the lookup counters
+typedef struct {
+    size_t bytes_read;
+    size_t line_count;
+    size_t section_count;
+    size_t entry_count;
+    size_t value_count;
+    uint64_t io_ns;
+    uint64_t tokenize_ns;
+    uint64_t number_ns;
+    size_t number_count;
+    uint64_t lookup_count; // The lookup counters are atomic, the getters run on the threads without the lock
+    uint64_t lookup_hit_count;
+    uint64_t probe_count;
+} CINI_IN_STATS;
+
+struct CINI_IN_PARSER_;
+
+typedef struct {
+    int filtered;
+    CINI_IN_MAPPING mapping;
+    int zero_copy;
+    CINI_IN_IMAGE image;
+    char* image_buffer; // The image made by cini_compact
+    const char* source_path;
+    uint64_t source_size;
+    int64_t source_mtime;
+    CINI_IN_ARENA arena;
     CINI_IN_LIST error_list;
     CINI_IN_LIST section_list;
+    CINI_IN_INDEX section_index;
+    CINI_IN_INDEX entry_index;
+    CINI_IN_INDEX string_index;
+    size_t shared_count;
+    size_t saved_bytes;
+    CINI_IN_STATS stats;
+    int lazy;                     // cini_create_lazy, the sections are parsed at the first access
+    CINI_IN_LIST range_list;
+    CINI_IN_RANGE* counted_range; // The last range whose line number is known
+    CINI_IN_LOCK lock;
+    const struct CINI_IN_PARSER_* parser;
+} CINI_IN_HANDLE;
+
+// The state only while parsing, the handle is not modified except the lazy values after it was created
+// In the event mode the 'cini' is null, the lines are reported to the 'events' instead of adding them to the handle
+typedef struct CINI_IN_PARSER_ {
+    CINI_IN_HANDLE* cini;
+    const CINI_EVENTS* events;
+    void* user_data;
+    int stopped; // A callback returned 0
+    const CINI_IN_STRING* target_sections;
+    int target_count;
+    int skipping;
     CINI_IN_SECTION* current_section;
-    char error_buffer[CINI_IN_ERROR_BUFFER_SIZE];
-    char line_buffer[CINI_LINE_BUFFER_SIZE];
+    uint32_t current_section_hash;
     int line_no;
-} CINI_IN_HANDLE;
+    uint64_t start_ns; // The time when the parse started
+    uint64_t io_ns;    // The time spent in the I/O while parsing
+} CINI_IN_PARSER;
 
-static void* cini_in_allocate(CINI_IN_LIST* memory_list, size_t size);
+static void* cini_in_allocate(CINI_IN_ARENA* arena, size_t size);
 static void cini_in_error(CINI_IN_HANDLE* cini, const char* message);
+static CINI_IN_SECTION* cini_in_parse_section(CINI_IN_HANDLE* cini, CINI_IN_SECTION* section);
+
+static uint64_t cini_in_now_ns(void)
+{
+    // Monotonic clock for the parse statistics
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#elif defined(CINI_IN_POSIX_2008)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#elif defined(TIME_UTC)
+    // C11 without POSIX: The calendar time, it may jump if the clock is adjusted while parsing
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    // C99 without POSIX: The processor time
+    return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
 
 static FILE* cini_in_fopen(const char* filename, const char* mode)
 {
@@ -193,7 +1169,157 @@ static FILE* cini_in_fopen(const char* filename, const char* mode)
 
 static int cini_in_isspace(char c)
 {
-    return isspace((unsigned char)c);
+    // Same as isspace of "C" locale without the function call
+    return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+static int cini_in_isblank_range(const char* begin, const char* end)
+{
+    for (; begin < end; ++begin) {
+        if (!cini_in_isspace(*begin)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int cini_in_ischar(const char* chars, char c)
+{
+    return c != '\0' && strchr(chars, c) != NULL;
+}
+
+// Up to 4 characters to find at once, the unused slots repeat the first character
+typedef struct {
+    char chars[4];
+} CINI_IN_CHARSET;
+
+static CINI_IN_CHARSET cini_in_make_charset(const char* chars)
+{
+    CINI_IN_CHARSET set;
+    size_t len = strlen(chars);
+    assert(0 < len && len <= sizeof(set.chars));
+    for (size_t i = 0; i < sizeof(set.chars); ++i) {
+        set.chars[i] = chars[(i < len) ? i : 0];
+    }
+    return set;
+}
+
+static const char* cini_in_scan_scalar(const char* begin, const char* end, const CINI_IN_CHARSET* set)
+{
+    const char* ptr = begin;
+    for (; ptr < end; ++ptr) {
+        char c = *ptr;
+        if (c == set->chars[0] || c == set->chars[1] || c == set->chars[2] || c == set->chars[3]) {
+            break;
+        }
+    }
+    return ptr;
+}
+
+#if defined(CINI_IN_SIMD)
+static int cini_in_lowest_bit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index_;
+    _BitScanForward(&index_, mask);
+    return (int)index_;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static const char* cini_in_scan_sse2(const char* begin, const char* end, const CINI_IN_CHARSET* set)
+{
+    // Compare 16 bytes with the all of characters and take the first match from the bit mask
+    const __m128i c0 = _mm_set1_epi8(set->chars[0]);
+    const __m128i c1 = _mm_set1_epi8(set->chars[1]);
+    const __m128i c2 = _mm_set1_epi8(set->chars[2]);
+    const __m128i c3 = _mm_set1_epi8(set->chars[3]);
+    const char* ptr = begin;
+    for (; 16 <= end - ptr; ptr += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)ptr);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, c0), _mm_cmpeq_epi8(block, c1)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, c2), _mm_cmpeq_epi8(block, c3)));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+        if (mask != 0) {
+            return ptr + cini_in_lowest_bit(mask);
+        }
+    }
+    return cini_in_scan_scalar(ptr, end, set);
+}
+
+CINI_IN_TARGET_AVX2 static const char* cini_in_scan_avx2(const char* begin, const char* end, const CINI_IN_CHARSET* set)
+{
+    const __m256i c0 = _mm256_set1_epi8(set->chars[0]);
+    const __m256i c1 = _mm256_set1_epi8(set->chars[1]);
+    const __m256i c2 = _mm256_set1_epi8(set->chars[2]);
+    const __m256i c3 = _mm256_set1_epi8(set->chars[3]);
+    const char* ptr = begin;
+    for (; 32 <= end - ptr; ptr += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)ptr);
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, c0), _mm256_cmpeq_epi8(block, c1)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, c2), _mm256_cmpeq_epi8(block, c3)));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+        if (mask != 0) {
+            return ptr + cini_in_lowest_bit(mask);
+        }
+    }
+    return cini_in_scan_sse2(ptr, end, set);
+}
+
+static int cini_in_has_avx2(void)
+{
+#if defined(_MSC_VER)
+    // AVX2 needs the support of OS to save the YMM registers as well
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return 0;
+    }
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+        return 0;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static int cini_in_scan_level = -1;
+
+static int cini_in_select_scan(void)
+{
+    // The level is selected on the first call, the other threads may select the same level at the same time
+    int level = CINI_IN_LOAD_INT(&cini_in_scan_level);
+    if (level < 0) {
+        level = cini_in_has_avx2() ? CINI_IN_SCAN_AVX2 : CINI_IN_SCAN_SSE2;
+        CINI_IN_STORE_INT(&cini_in_scan_level, level);
+    }
+    return level;
+}
+#endif
+
+static const char* cini_in_scan(const char* begin, const char* end, const CINI_IN_CHARSET* set)
+{
+    // Find the first character in the set, the function returns 'end' if not found
+    // The short string is faster without the block setup
+    if (end - begin < 16) {
+        return cini_in_scan_scalar(begin, end, set);
+    }
+#if defined(CINI_IN_SIMD)
+    switch (cini_in_select_scan()) {
+    case CINI_IN_SCAN_AVX2:
+        return cini_in_scan_avx2(begin, end, set);
+    case CINI_IN_SCAN_SSE2:
+        return cini_in_scan_sse2(begin, end, set);
+    default:
+        break;
+    }
+#endif
+    return cini_in_scan_scalar(begin, end, set);
 }
 
 static const char* cini_in_skip_bom(const char* str)
@@ -201,18 +1327,17 @@ static const char* cini_in_skip_bom(const char* str)
     return ((unsigned char)str[0] == 0xEFu && (unsigned char)str[1] == 0xBBu && (unsigned char)str[2] == 0xBFu) ? (str + 3) : str;
 }
 
-static size_t cini_in_string_len(CINI_IN_STRING* str)
+static size_t cini_in_string_len(const CINI_IN_STRING* str)
 {
     return (str != NULL && str->begin != NULL && str->end != NULL && (str->begin <= str->end)) ? (str->end - str->begin) : 0;
 }
 
-static CINI_IN_STRING cini_in_string_trim(CINI_IN_STRING* str)
+static CINI_IN_STRING cini_in_string_trim(const CINI_IN_STRING* str)
 {
     CINI_IN_STRING s = { NULL, NULL };
     if (str != NULL && str->begin != NULL && str->end != NULL) {
         for (s.begin = str->begin; s.begin < str->end && cini_in_isspace(*s.begin); ++s.begin) { }
-        for (s.end = str->end - 1; str->begin <= s.end && cini_in_isspace(*s.end); --s.end) { }
-        ++s.end;
+        for (s.end = str->end; s.begin < s.end && cini_in_isspace(*(s.end - 1)); --s.end) { }
     }
     return s;
 }
@@ -230,7 +1355,7 @@ static int cini_in_list_count(const CINI_IN_LIST* list)
 
 static CINI_IN_LIST_NODE* cini_in_list_push_back(CINI_IN_HANDLE* cini, CINI_IN_LIST* list, size_t size)
 {
-    CINI_IN_LIST_NODE* node = (CINI_IN_LIST_NODE*)cini_in_allocate(&cini->memory_list, size);
+    CINI_IN_LIST_NODE* node = (CINI_IN_LIST_NODE*)cini_in_allocate(&cini->arena, size);
     if (node != NULL) {
         memset(node, 0, size);
         if (list->front == NULL) {
@@ -245,24 +1370,24 @@ static CINI_IN_LIST_NODE* cini_in_list_push_back(CINI_IN_HANDLE* cini, CINI_IN_L
     return node;
 }
 
-static CINI_IN_LIST_NODE* cini_in_list_at(const CINI_IN_LIST* list, int index_)
+static void cini_in_list_append(CINI_IN_LIST* list, CINI_IN_LIST_NODE* node)
 {
-    CINI_IN_LIST_NODE* found_node = NULL;
-    int i = 0;
-    for (CINI_IN_LIST_NODE* node = list->front; node != NULL; node = node->next, ++i) {
-        if (i == index_) {
-            found_node = node;
-            break;
-        }
+    // Link the node which is already allocated, e.g. moved from the other list
+    node->next = NULL;
+    if (list->front == NULL) {
+        list->front = node;
+    } else {
+        list->back->next = node;
     }
-    return found_node;
+    list->back = node;
 }
 
-static CINI_IN_LIST_NODE* cini_in_list_find(const CINI_IN_LIST* list, int (*match_func)(CINI_IN_LIST_NODE*, const void*), const void* data)
+static CINI_IN_LIST_NODE* cini_in_list_at(const CINI_IN_LIST* list, int index_)
 {
     CINI_IN_LIST_NODE* found_node = NULL;
-    for (CINI_IN_LIST_NODE* node = list->front; node != NULL; node = node->next) {
-        if (match_func(node, data)) {
+    int i = 0;
+    for (CINI_IN_LIST_NODE* node = list->front; node != NULL; node = node->next, ++i) {
+        if (i == index_) {
             found_node = node;
             break;
         }
@@ -272,383 +1397,2943 @@ static CINI_IN_LIST_NODE* cini_in_list_find(const CINI_IN_LIST* list, int (*matc
 
 static void cini_in_error(CINI_IN_HANDLE* cini, const char* message)
 {
-    int len = snprintf(cini->error_buffer, sizeof(cini->error_buffer), "%s (line:%d)", message, cini->line_no);
+    // The errors are recorded only while creating the handle, the line number is 0 if it is not parsing
+    char error_buffer[CINI_IN_ERROR_BUFFER_SIZE];
+    int len = snprintf(error_buffer, sizeof(error_buffer), "%s (line:%d)", message, (cini->parser != NULL) ? cini->parser->line_no : 0);
+    if ((size_t)len >= sizeof(error_buffer)) {
+        len = (int)sizeof(error_buffer) - 1;
+    }
     if (0 < len) {
+        // Not recorded if the memory is exhausted, cini_in_list_push_back would report it again
         size_t size = sizeof(CINI_IN_ERROR) + len + 1;
-        CINI_IN_ERROR* error = (CINI_IN_ERROR*)cini_in_list_push_back(cini, &cini->error_list, size);
+        CINI_IN_ERROR* error = (CINI_IN_ERROR*)cini_in_allocate(&cini->arena, size);
         if (error != NULL) {
             char* s = (char*)(error + 1);
-            memcpy(s, cini->error_buffer, len);
+            memset(error, 0, size);
+            memcpy(s, error_buffer, len);
             error->message = s;
+            cini_in_list_append(&cini->error_list, &error->node);
         }
     }
 }
 
-static void* cini_in_allocate(CINI_IN_LIST* memory_list, size_t size)
+static void* cini_in_default_alloc(void* user_data, size_t size)
+{
+    (void)user_data;
+    return CINI_MALLOC(size);
+}
+
+static void cini_in_default_free(void* user_data, void* ptr)
+{
+    (void)user_data;
+    CINI_FREE(ptr);
+}
+
+static void cini_in_init_arena(CINI_IN_ARENA* arena, const CINI_ALLOCATOR* allocator)
+{
+    memset(arena, 0, sizeof(CINI_IN_ARENA));
+    if (allocator != NULL && allocator->alloc != NULL && allocator->free != NULL) {
+        arena->allocator = *allocator;
+    } else {
+        arena->allocator.alloc = cini_in_default_alloc;
+        arena->allocator.free = cini_in_default_free;
+    }
+    arena->chunk_size = CINI_MEMORY_CHUNK_SIZE;
+}
+
+static void* cini_in_arena_malloc(const CINI_IN_ARENA* arena, size_t size)
+{
+    // The temporary buffer out of the chunks, it must be released by cini_in_arena_free
+    return arena->allocator.alloc(arena->allocator.user_data, size);
+}
+
+static void cini_in_arena_free(const CINI_IN_ARENA* arena, void* ptr)
+{
+    if (ptr != NULL) {
+        arena->allocator.free(arena->allocator.user_data, ptr);
+    }
+}
+
+static CINI_IN_MEMORY* cini_in_new_memory(CINI_IN_ARENA* arena, size_t capacity)
 {
+    CINI_IN_MEMORY* memory = (CINI_IN_MEMORY*)cini_in_arena_malloc(arena, sizeof(CINI_IN_MEMORY) + capacity);
+    if (memory != NULL) {
+        arena->allocated += sizeof(CINI_IN_MEMORY) + capacity;
+        arena->chunk_count += 1;
+        memset(memory, 0, sizeof(CINI_IN_MEMORY));
+        memory->ptr = (char*)(memory + 1);
+        memory->end = memory->ptr + capacity;
+    }
+    return memory;
+}
+
+static size_t cini_in_align(size_t size)
+{
+    return (size + CINI_IN_MEMORY_ALIGNMENT - 1) & ~(CINI_IN_MEMORY_ALIGNMENT - 1);
+}
+
+static void cini_in_free_memory(CINI_IN_ARENA* arena, CINI_IN_MEMORY* memory)
+{
+    arena->allocated -= sizeof(CINI_IN_MEMORY) + (memory->end - (char*)(memory + 1));
+    memset(memory + 1, 0, memory->end - (char*)(memory + 1));
+    memset(memory, 0, sizeof(CINI_IN_MEMORY));
+    cini_in_arena_free(arena, memory);
+}
+
+static void* cini_in_allocate(CINI_IN_ARENA* arena, size_t size)
+{
+    // The chunk grows twice as large as the previous one so that the number of chunks is logarithmic in the data size
+    // The allocation larger than a quarter of the chunk uses the dedicated block, so the tail left in a chunk is small
     char* ptr = NULL;
-    if (memory_list != NULL && size <= CINI_MEMORY_CHUNK_SIZE) {
-        CINI_IN_MEMORY* memory = (CINI_IN_MEMORY*)memory_list->back;
+    size_t padding = cini_in_align(size) - size;
+    size += padding;
+    if (arena != NULL && arena->chunk_size / 4 < size) {
+        // Large allocation: Keep the current chunk at the back
+        CINI_IN_MEMORY* memory = cini_in_new_memory(arena, size);
+        if (memory != NULL) {
+            memory->node.next = arena->list.front;
+            arena->list.front = &memory->node;
+            if (arena->list.back == NULL) {
+                arena->list.back = &memory->node;
+            }
+            ptr = memory->ptr;
+            memory->ptr += size;
+            arena->wasted_bytes += padding;
+        }
+    } else if (arena != NULL) {
+        CINI_IN_MEMORY* memory = (CINI_IN_MEMORY*)arena->list.back;
         size_t remain = 0;
         if (memory != NULL) {
-            remain = CINI_MEMORY_CHUNK_SIZE - (memory->ptr - memory->chunk);
+            remain = memory->end - memory->ptr;
         }
         if (remain < size) {
-            CINI_IN_LIST_NODE* new_node = (CINI_IN_LIST_NODE*)CINI_MALLOC(sizeof(CINI_IN_MEMORY));
-            if (new_node != NULL) {
-                memset(new_node, 0, sizeof(CINI_IN_MEMORY));
-                if (memory_list->front == NULL) {
-                    memory_list->front = new_node;
+            memory = cini_in_new_memory(arena, arena->chunk_size);
+            if (memory != NULL) {
+                if (arena->list.front == NULL) {
+                    arena->list.front = &memory->node;
                 } else {
-                    memory_list->back->next = new_node;
+                    arena->list.back->next = &memory->node;
+                }
+                arena->list.back = &memory->node;
+                arena->wasted_bytes += remain;
+                if (arena->chunk_size < CINI_MEMORY_CHUNK_SIZE_MAX) {
+                    arena->chunk_size *= 2;
                 }
-                memory_list->back = new_node;
-                memory = (CINI_IN_MEMORY*)new_node;
-                memory->ptr = memory->chunk;
             }
         }
 
         if (memory != NULL) {
             ptr = memory->ptr;
             memory->ptr += size;
+            arena->wasted_bytes += padding;
         }
     }
     return ptr;
 }
 
-static CINI_IN_VALUE* cini_in_add_value_single(CINI_IN_HANDLE* cini, CINI_IN_LIST* value_list, CINI_IN_STRING* source)
+static void cini_in_release(CINI_IN_ARENA* arena, void* ptr, size_t size)
 {
-    CINI_IN_STRING str = cini_in_string_trim(source);
-    const char* str_ptr = str.begin;
-    int negative = 0;
-    double numeric = NAN;
-    if (*str_ptr == '+' || *str_ptr == '-') {
-        negative = (*str_ptr == '-') ? 1 : 0;
-        ++str_ptr;
+    // Return the large allocation to the allocator before the handle is released
+    // Only the dedicated block is released, the allocation in the chunk is left until the handle is released
+    // The chunk never holds a single allocation of its capacity, so the block of the exact size is the dedicated one
+    CINI_IN_LIST_NODE* prev = NULL;
+    size = cini_in_align(size);
+    if (arena == NULL || ptr == NULL || size <= arena->chunk_size / 4) {
+        return;
     }
-    if (str_ptr != str.end) {
-        char* endp = NULL;
-        double n = NAN;
-        errno = 0;
-        if (*str_ptr == '#') {
-            if ((str_ptr + 1) != str.end) {
-                n = (double)strtoll(str_ptr + 1, &endp, 16);
-            }
-        } else if (*str_ptr == '0' && (*(str_ptr + 1) == 'X' || *(str_ptr + 1) == 'x')) {
-            if ((str_ptr + 2) != str.end) {
-                n = (double)strtoll(str_ptr + 2, &endp, 16);
-            }
-        } else {
-            n = strtod(str_ptr, &endp);
-        }
-        if (endp == str.end) {
-            if (errno != ERANGE && -FLT_MAX <= n && n <= FLT_MAX) {
-                numeric = n;
+    for (CINI_IN_LIST_NODE* node = arena->list.front; node != NULL; prev = node, node = node->next) {
+        CINI_IN_MEMORY* memory = (CINI_IN_MEMORY*)node;
+        if ((char*)(memory + 1) == (char*)ptr && (size_t)(memory->end - (char*)ptr) == size) {
+            if (prev != NULL) {
+                prev->next = node->next;
             } else {
-                // Out of range
+                arena->list.front = node->next;
             }
+            if (arena->list.back == node) {
+                arena->list.back = prev;
+            }
+            arena->released_bytes += size;
+            cini_in_free_memory(arena, memory);
+            return;
         }
     }
+}
 
-    if (!isnan(numeric)) {
-        // Numeric:
-        numeric = negative ? -numeric : numeric;
-    } else {
-        // String: Remove the quote mark of both ends
-        if (2 <= cini_in_string_len(&str) && strchr(CINI_IN_QUOTE_CHARS, *str.begin) != NULL && *str.begin == *(str.end - 1)) {
-            str.begin += 1;
-            str.end -= 1;
-        }
+static uint32_t cini_in_hash(uint32_t hash, const CINI_IN_STRING* str)
+{
+    // FNV-1a
+    for (const char* c = str->begin; c < str->end; ++c) {
+        hash = (hash ^ (unsigned char)*c) * CINI_IN_HASH_PRIME;
     }
+    return hash;
+}
 
-    size_t len = cini_in_string_len(&str);
-    size_t size = sizeof(CINI_IN_VALUE) + len + 1;
-    CINI_IN_VALUE* value = (CINI_IN_VALUE*)cini_in_list_push_back(cini, value_list, size);
-    if (value != NULL) {
-        char* s = (char*)(value + 1);
-        memcpy(s, str.begin, len);
-        value->s = s;
-        value->f = numeric;
-    }
+static uint32_t cini_in_hash_section(const CINI_IN_STRING* section_name)
+{
+    return cini_in_hash(CINI_IN_HASH_OFFSET_BASIS, section_name);
+}
 
-    return value;
+static uint32_t cini_in_hash_entry(uint32_t section_hash, const CINI_IN_STRING* key_name)
+{
+    // Mix a null separator so that "ab"+"c" and "a"+"bc" are hashed differently
+    return cini_in_hash(section_hash * CINI_IN_HASH_PRIME, key_name);
 }
 
-static void cini_in_add_value_array(CINI_IN_HANDLE* cini, CINI_IN_LIST* value_list, CINI_IN_STRING* source)
+static size_t cini_in_index_home(int bits, uint32_t hash)
 {
-    const char* str_ptr = source->begin;
-    while (str_ptr <= source->end) {
-        // It is not "str_ptr < source_end" because pick up the empty string on end of line.
-        // ex. key = 1,2,3, <<< number of elements is 4. (1, 2, 3 and "")
-        int quoteChar = 0;
-        int quoteOpen = 0;
-        const char* separator = NULL;
-        CINI_IN_STRING value_str = { str_ptr, source->end };
-        for (; str_ptr < source->end; ++str_ptr) {
-            if (!cini_in_isspace(*str_ptr)) {
-                if (strchr(CINI_IN_QUOTE_CHARS, *str_ptr) != NULL) {
-                    quoteChar = *str_ptr++;
-                    quoteOpen = 1;
-                }
+    // Fibonacci hashing: Take the upper bits after multiplying to spread the FNV result over the table
+    return (size_t)((uint32_t)(hash * 2654435769u) >> (32 - bits));
+}
+
+static CINI_IN_LIST_NODE* cini_in_index_find(const CINI_IN_INDEX* index, uint32_t hash, int (*match_func)(CINI_IN_LIST_NODE*, const void*), const void* data)
+{
+    CINI_IN_LIST_NODE* found_node = NULL;
+    if (index->slots != NULL) {
+        size_t mask = ((size_t)1 << index->bits) - 1;
+        for (size_t i = cini_in_index_home(index->bits, hash); index->slots[i].node != NULL; i = (i + 1) & mask) {
+            if (index->slots[i].hash == hash && match_func(index->slots[i].node, data)) {
+                found_node = index->slots[i].node;
                 break;
             }
         }
+    }
+    return found_node;
+}
 
-        for (; str_ptr < source->end; ++str_ptr) {
-            if (cini_in_isspace(*str_ptr)) {
-                // Skip
-            } else if (*str_ptr == CINI_IN_ARRAY_SEPARATOR) {
-                if (quoteOpen) {
-                    if (separator == NULL) {
-                        separator = str_ptr;
-                    }
-                } else {
-                    value_str.end = str_ptr;
-                    break;
-                }
-            } else {
-                if (quoteChar) {
-                    quoteOpen = (*str_ptr != quoteChar);
-                }
+static void cini_in_index_put(CINI_IN_INDEX* index, uint32_t hash, CINI_IN_LIST_NODE* node)
+{
+    size_t mask = ((size_t)1 << index->bits) - 1;
+    size_t i = cini_in_index_home(index->bits, hash);
+    while (index->slots[i].node != NULL) {
+        i = (i + 1) & mask;
+    }
+    index->slots[i].hash = hash;
+    index->slots[i].node = node;
+    index->count += 1;
+}
+
+static int cini_in_index_rehash(CINI_IN_HANDLE* cini, CINI_IN_INDEX* index, int bits)
+{
+    size_t size = sizeof(CINI_IN_INDEX_SLOT) << bits;
+    CINI_IN_INDEX new_index = { (CINI_IN_INDEX_SLOT*)cini_in_allocate(&cini->arena, size), 0, bits };
+    if (new_index.slots == NULL) {
+        cini_in_error(cini, "Failed to allocate memory");
+        return 0;
+    }
+    memset(new_index.slots, 0, size);
+    if (index->slots != NULL) {
+        for (size_t i = 0; i < ((size_t)1 << index->bits); ++i) {
+            if (index->slots[i].node != NULL) {
+                cini_in_index_put(&new_index, index->slots[i].hash, index->slots[i].node);
             }
         }
+        // The old slots are released if they are in the dedicated block
+        cini_in_release(&cini->arena, index->slots, sizeof(CINI_IN_INDEX_SLOT) << index->bits);
+    }
+    *index = new_index;
+    return 1;
+}
 
-        if (quoteOpen && separator != NULL) {
-            value_str.end = separator;
+static int cini_in_index_add(CINI_IN_HANDLE* cini, CINI_IN_INDEX* index, uint32_t hash, CINI_IN_LIST_NODE* node)
+{
+    // Keep the load factor 1/2 or less so that the probe sequences stay short
+    if (index->slots == NULL || ((size_t)1 << index->bits) < (index->count + 1) * 2) {
+        if (!cini_in_index_rehash(cini, index, (index->slots != NULL) ? (index->bits + 1) : CINI_IN_INDEX_INITIAL_BITS)) {
+            return 0;
         }
+    }
+    cini_in_index_put(index, hash, node);
+    return 1;
+}
 
-        cini_in_add_value_single(cini, value_list, &value_str);
+static size_t cini_in_index_bytes(const CINI_IN_INDEX* index)
+{
+    return (index->slots != NULL) ? (sizeof(CINI_IN_INDEX_SLOT) << index->bits) : 0;
+}
 
-        str_ptr = value_str.end + 1;
+static int cini_in_index_reserve(CINI_IN_HANDLE* cini, CINI_IN_INDEX* index, size_t count)
+{
+    // Grow the slots at once so that adding up to 'count' nodes in total does not rehash
+    int bits = (index->slots != NULL) ? index->bits : CINI_IN_INDEX_INITIAL_BITS;
+    while (((size_t)1 << bits) < count * 2) {
+        ++bits;
     }
-    return;
+    return (index->slots != NULL && bits == index->bits) ? 1 : cini_in_index_rehash(cini, index, bits);
 }
 
-static void cini_in_add_value(CINI_IN_HANDLE* cini, CINI_IN_LIST* value_list, CINI_IN_STRING* source)
+static int cini_in_parse_hex(const char* begin, const char* end, uint64_t* n)
 {
-    cini_in_add_value_single(cini, value_list, source);
-    cini_in_add_value_array(cini, value_list, source);
-    return;
+    // Up to 16 digits fit in uint64_t, the longer number is left to strtoll
+    uint64_t value = 0;
+    if (begin == end || 16 < end - begin) {
+        return 0;
+    }
+    for (const char* c = begin; c < end; ++c) {
+        int digit = ('0' <= *c && *c <= '9') ? (*c - '0') : ('a' <= *c && *c <= 'f') ? (*c - 'a' + 10) : ('A' <= *c && *c <= 'F') ? (*c - 'A' + 10) : -1;
+        if (digit < 0) {
+            return 0;
+        }
+        value = (value << 4) | (uint64_t)digit;
+    }
+    *n = value;
+    return 1;
 }
 
-static CINI_IN_ENTRY* cini_in_add_entry(CINI_IN_HANDLE* cini, CINI_IN_LIST* entry_list, CINI_IN_STRING* name)
+static int cini_in_parse_digits(const char* begin, const char* end, uint64_t* n)
 {
-    size_t len = cini_in_string_len(name);
-    size_t size = sizeof(CINI_IN_ENTRY) + len + 1;
-    CINI_IN_ENTRY* entry = (CINI_IN_ENTRY*)cini_in_list_push_back(cini, entry_list, size);
-    if (entry != NULL) {
-        char* s = (char*)(entry + 1);
-        memcpy(s, name->begin, len);
-        entry->name = s;
+    // Decimal integer without overflow, the other numbers are left to cini_in_parse_decimal
+    uint64_t value = 0;
+    if (begin == end) {
+        return 0;
     }
-    return entry;
+    for (const char* c = begin; c < end; ++c) {
+        uint64_t digit = (uint64_t)(*c - '0');
+        if (9 < digit || (UINT64_MAX - digit) / 10 < value) {
+            return 0;
+        }
+        value = value * 10 + digit;
+    }
+    *n = value;
+    return 1;
 }
 
-static CINI_IN_SECTION* cini_in_add_section(CINI_IN_HANDLE* cini, CINI_IN_LIST* section_list, CINI_IN_STRING* name)
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 CINI_IN_UINT128;
+
+static double cini_in_round_wide(CINI_IN_UINT128 value, int sticky, int exponent)
 {
-    size_t len = cini_in_string_len(name);
-    size_t size = sizeof(CINI_IN_SECTION) + len + 1;
-    CINI_IN_SECTION* section = (CINI_IN_SECTION*)cini_in_list_push_back(cini, section_list, size);
-    if (section != NULL) {
-        char* s = (char*)(section + 1);
-        memcpy(s, name->begin, len);
-        section->name = s;
+    // Round value * 2^exponent to the nearest double (ties to even), 'sticky' is set if the value was truncated
+    uint64_t high = (uint64_t)(value >> 64);
+    int bits = (high != 0) ? 128 - __builtin_clzll(high) : 64 - __builtin_clzll((uint64_t)value);
+    int shift = bits - DBL_MANT_DIG;
+    if (shift <= 0) {
+        return ldexp((double)(uint64_t)value, exponent);
     }
-    return section;
+    CINI_IN_UINT128 half = (CINI_IN_UINT128)1 << (shift - 1);
+    CINI_IN_UINT128 lower = value & ((half << 1) - 1);
+    uint64_t significand = (uint64_t)(value >> shift);
+    if (half < lower || (lower == half && (sticky || (significand & 1)))) {
+        significand += 1;
+    }
+    return ldexp((double)significand, exponent + shift);
 }
 
-static int cini_in_match_entry(CINI_IN_LIST_NODE* node, const void* data)
+static int cini_in_parse_wide_decimal(uint64_t mantissa, int exponent, double* n)
 {
-    return strncmp(((CINI_IN_STRING*)data)->begin, ((CINI_IN_ENTRY*)node)->name, cini_in_string_len((CINI_IN_STRING*)data)) == 0;
+    // The long mantissa (e.g. %.17g) is out of the Clinger's fast path, but mantissa * 5^e is exact in 128 bits
+    // if 5^e fits in 64 bits, so the result is rounded once as strtod does
+    // 10^e = 5^e * 2^e: The power of two goes to the exponent, the division by 5^e keeps at least 64 bits of the quotient
+    static const uint64_t pow5[] = {
+        1ull, 5ull, 25ull, 125ull, 625ull, 3125ull, 15625ull, 78125ull, 390625ull, 1953125ull,
+        9765625ull, 48828125ull, 244140625ull, 1220703125ull, 6103515625ull, 30517578125ull,
+        152587890625ull, 762939453125ull, 3814697265625ull, 19073486328125ull, 95367431640625ull,
+        476837158203125ull, 2384185791015625ull, 11920928955078125ull, 59604644775390625ull,
+        298023223876953125ull, 1490116119384765625ull, 7450580596923828125ull
+    };
+    const int max_pow5 = (int)(sizeof(pow5) / sizeof(pow5[0])) - 1;
+    if (0 <= exponent && exponent <= max_pow5) {
+        *n = cini_in_round_wide((CINI_IN_UINT128)mantissa * pow5[exponent], 0, exponent);
+    } else if (-max_pow5 <= exponent && exponent < 0) {
+        int shift = 63 + __builtin_clzll(mantissa);
+        CINI_IN_UINT128 dividend = (CINI_IN_UINT128)mantissa << shift;
+        CINI_IN_UINT128 quotient = dividend / pow5[-exponent];
+        int sticky = (dividend - quotient * pow5[-exponent]) != 0;
+        *n = cini_in_round_wide(quotient, sticky, exponent - shift);
+    } else {
+        return 0;
+    }
+    return 1;
 }
+#endif
 
-static int cini_in_match_section(CINI_IN_LIST_NODE* node, const void* data)
+static int cini_in_parse_decimal(const char* begin, const char* end, double* n)
 {
-    return strncmp(((CINI_IN_STRING*)data)->begin, ((CINI_IN_SECTION*)node)->name, cini_in_string_len((CINI_IN_STRING*)data)) == 0;
+    // Clinger's fast path: If the mantissa and the power of ten are exact in double,
+    // a single multiplication or division is correctly rounded, so the result is the same as strtod
+    // The mantissa over 2^53 is rounded in 128 bits by cini_in_parse_wide_decimal where the compiler has __int128
+    // The other numbers (more than 19 digits, large exponent, inf, nan...) are left to strtod
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const int max_pow10 = (int)(sizeof(pow10) / sizeof(pow10[0])) - 1;
+    const uint64_t max_mantissa = (uint64_t)1 << DBL_MANT_DIG;
+    const char* ptr = begin;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int has_digit = 0;
+    int exponent = 0;
+    for (int fraction = 0; ptr < end; ++ptr) {
+        if ('0' <= *ptr && *ptr <= '9') {
+            if (19 <= digits) {
+                return 0;
+            }
+            mantissa = mantissa * 10 + (uint64_t)(*ptr - '0');
+            digits += (mantissa != 0);
+            exponent -= fraction;
+            has_digit = 1;
+        } else if (*ptr == '.' && !fraction) {
+            fraction = 1;
+        } else {
+            break;
+        }
+    }
+    if (!has_digit) {
+        return 0;
+    }
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+        int exponent_negative = 0;
+        int exponent_value = 0;
+        ++ptr;
+        if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+            exponent_negative = (*ptr == '-');
+            ++ptr;
+        }
+        if (ptr == end) {
+            return 0;
+        }
+        for (; ptr < end && '0' <= *ptr && *ptr <= '9'; ++ptr) {
+            exponent_value = (exponent_value < 10000) ? (exponent_value * 10 + (*ptr - '0')) : exponent_value;
+        }
+        exponent += exponent_negative ? -exponent_value : exponent_value;
+    }
+    if (ptr != end) {
+        return 0;
+    }
+    if (mantissa == 0) {
+        *n = 0.0;
+    } else if (!CINI_IN_FAST_FLOAT) {
+        return 0;
+    } else if (max_mantissa < mantissa) {
+#if defined(__SIZEOF_INT128__)
+        return cini_in_parse_wide_decimal(mantissa, exponent, n);
+#else
+        return 0;
+#endif
+    } else if (-max_pow10 <= exponent && exponent < 0) {
+        *n = (double)mantissa / pow10[-exponent];
+    } else if (0 <= exponent && exponent <= max_pow10) {
+        *n = (double)mantissa * pow10[exponent];
+    } else if (max_pow10 < exponent && exponent <= max_pow10 * 2) {
+        // 12e30 = 12000000e25, moving the zeros to the mantissa is exact while it fits
+        for (; max_pow10 < exponent && mantissa <= max_mantissa / 10; --exponent) {
+            mantissa *= 10;
+        }
+        if (max_pow10 < exponent) {
+            return 0;
+        }
+        *n = (double)mantissa * pow10[exponent];
+    } else {
+        return 0;
+    }
+    return 1;
 }
 
-static CINI_IN_ENTRY* cini_in_get_entry(CINI_IN_HANDLE* cini, const char* section_name, const char* key_name)
+static int cini_in_parse_integer(const char* begin, const char* end, uint64_t* n)
 {
-    CINI_IN_STRING section_name_str = { section_name, section_name + strlen(section_name) };
-    CINI_IN_STRING key_name_str = { key_name, key_name + strlen(key_name) };
-    CINI_IN_SECTION* section = (CINI_IN_SECTION*)cini_in_list_find(&cini->section_list, cini_in_match_section, &section_name_str);
-    return (section) ? (CINI_IN_ENTRY*)cini_in_list_find(&section->entry_list, cini_in_match_entry, &key_name_str) : NULL;
+    if (*begin == '#') {
+        return cini_in_parse_hex(begin + 1, end, n);
+    }
+    if (2 <= end - begin && begin[0] == '0' && (begin[1] == 'X' || begin[1] == 'x')) {
+        return cini_in_parse_hex(begin + 2, end, n);
+    }
+    return cini_in_parse_digits(begin, end, n);
 }
 
-static CINI_IN_VALUE* cini_in_get_value(CINI_IN_HANDLE* cini, const char* section_name, const char* key_name, int index_)
+static int cini_in_localize_number(char* number)
 {
-    CINI_IN_ENTRY* entry = cini_in_get_entry(cini, section_name, key_name);
-    return (entry) ? (CINI_IN_VALUE*)cini_in_list_at(&entry->value_list, index_) : NULL;
+    // strtod follows LC_NUMERIC, so '.' is replaced with the decimal point of the current locale
+    // The decimal point of the locale is not accepted so that the result does not depend on the locale
+    const char* point = localeconv()->decimal_point;
+    if (point == NULL || point[0] == '.' || point[0] == '\0' || point[1] != '\0') {
+        return 1;
+    }
+    if (strchr(number, point[0]) != NULL) {
+        return 0;
+    }
+    for (char* c = number; (c = strchr(c, '.')) != NULL; ++c) {
+        *c = point[0];
+    }
+    return 1;
 }
 
-static void cini_in_parse(CINI_IN_HANDLE* cini, FILE* file)
+static CINI_IN_NUMBER cini_in_parse_number(const CINI_IN_STRING* str)
 {
-    // Default section
-    const char* default_name = "";
-    CINI_IN_STRING default_name_str = { default_name, default_name + strlen(default_name) };
-    cini->current_section = cini_in_add_section(cini, &cini->section_list, &default_name_str);
-
-    while (fgets(cini->line_buffer, sizeof(cini->line_buffer), file) != NULL) {
-        ++cini->line_no;
-        size_t line_len = strlen(cini->line_buffer);
-        CINI_IN_STRING line = { cini->line_buffer, cini->line_buffer + line_len };
-        if (cini->line_no == 1 && 3 <= line_len) {
-            line.begin = cini_in_skip_bom(line.begin);
+    const char* str_ptr = str->begin;
+    int negative = 0;
+    double numeric = NAN;
+    double fast = NAN;
+    uint64_t integer = 0;
+    CINI_IN_NUMBER result = { NAN, 0, 0 };
+    if (str_ptr != str->end && (*str_ptr == '+' || *str_ptr == '-')) {
+        negative = (*str_ptr == '-') ? 1 : 0;
+        ++str_ptr;
+    }
+    char number[CINI_IN_NUMBER_BUFFER_SIZE];
+    size_t number_len = str->end - str_ptr;
+    if (str_ptr == str->end) {
+        // Empty
+    } else if (cini_in_parse_integer(str_ptr, str->end, &integer)) {
+        // The fast paths do not use errno and the locale
+        // The negative integer is exact down to INT64_MIN, the positive integer up to UINT64_MAX
+        if (!negative || integer <= (uint64_t)INT64_MAX + 1) {
+            result.i = negative ? (0 - integer) : integer;
+            result.flags = CINI_IN_NUMBER_INTEGER | ((!negative && (uint64_t)INT64_MAX < integer) ? CINI_IN_NUMBER_UNSIGNED : 0);
         }
-        line = cini_in_string_trim(&line);
-        if (strchr(CINI_IN_COMMENT_CHARS, *line.begin) != NULL) {
-            continue;
-        }
-        if (*line.begin == CINI_IN_SECTION_BRACKET_OPEN) {
-            ++line.begin;
-            CINI_IN_STRING section_name = { line.begin, strchr(line.begin, CINI_IN_SECTION_BRACKET_CLOSE) };
-            if (cini_in_string_len(&section_name) == 0) {
-                cini_in_error(cini, "Invalid section name");
-                continue;
-            }
-            CINI_IN_SECTION* existing_section = (CINI_IN_SECTION*)cini_in_list_find(&cini->section_list, cini_in_match_section, &section_name);
-            if (existing_section == NULL) {
-                cini->current_section = cini_in_add_section(cini, &cini->section_list, &section_name);
+        numeric = (double)integer;
+    } else if (cini_in_parse_decimal(str_ptr, str->end, &fast)) {
+        numeric = fast;
+    } else if (number_len < sizeof(number)) {
+        // Copy to the null terminated buffer because the value may not be terminated in zero-copy mode
+        const char* number_end = number + number_len;
+        char* endp = NULL;
+        double n = NAN;
+        int saved_errno = errno;
+        memcpy(number, str_ptr, number_len);
+        number[number_len] = '\0';
+        errno = 0;
+        if (number[0] == '#') {
+            if ((number + 1) != number_end) {
+                n = (double)strtoll(number + 1, &endp, 16);
+            }
+        } else if (number[0] == '0' && (number[1] == 'X' || number[1] == 'x')) {
+            if ((number + 2) != number_end) {
+                n = (double)strtoll(number + 2, &endp, 16);
+            }
+        } else if (cini_in_localize_number(number)) {
+            n = strtod(number, &endp);
+        }
+        if (endp == number_end) {
+            if (errno != ERANGE && -DBL_MAX <= n && n <= DBL_MAX) {
+                numeric = n;
             } else {
-                cini->current_section = existing_section;
+                // Out of range
             }
-        } else {
-            if (cini->current_section != NULL && (cini->target_section_name == NULL || strcmp(cini->current_section->name, cini->target_section_name) == 0)) {
-                CINI_IN_STRING key_name = { line.begin, line.begin };
-                for (; *key_name.end != 0; ++key_name.end) {
-                    if (strchr(CINI_IN_ASSIGNMENT_CHARS, *key_name.end) != NULL) {
-                        break;
-                    }
-                }
-                CINI_IN_STRING value_str = { key_name.end + 1, line.end };
-                key_name = cini_in_string_trim(&key_name);
-                if (cini_in_string_len(&key_name) == 0) {
-                    cini_in_error(cini, "Invalid key name");
-                    continue;
-                }
-                CINI_IN_ENTRY* entry = (CINI_IN_ENTRY*)cini_in_list_find(&cini->current_section->entry_list, cini_in_match_entry, &key_name);
-                if (entry == NULL) {
-                    entry = cini_in_add_entry(cini, &cini->current_section->entry_list, &key_name);
-                    if (entry == NULL) {
-                        continue;
-                    }
-                    cini_in_add_value(cini, &entry->value_list, &value_str);
+        }
+        // The getters do not change errno of the caller
+        errno = saved_errno;
+    }
+    result.f = (!isnan(numeric) && negative) ? -numeric : numeric;
+    return result;
+}
+
+static void cini_in_set_value(CINI_IN_VALUE* value, const CINI_IN_STRING* source)
+{
+    // The numeric conversion is deferred until cini_in_value_numeric is called
+    CINI_IN_STRING str = cini_in_string_trim(source);
+    value->flags = 0;
+    if (2 <= cini_in_string_len(&str) && cini_in_ischar(CINI_IN_QUOTE_CHARS, *str.begin) && *str.begin == *(str.end - 1)) {
+        // String: Remove the quote mark of both ends, a quoted value is never numeric
+        str.begin += 1;
+        str.end -= 1;
+        value->flags |= CINI_IN_VALUE_QUOTED;
+    }
+    value->view = str;
+    value->s = NULL;
+    value->number.f = NAN;
+    value->number.i = 0;
+    value->number.flags = 0;
+}
+
+static int cini_in_next_element(const char** ptr, const CINI_IN_STRING* source, CINI_IN_STRING* element)
+{
+    // It is not "str_ptr < source_end" because pick up the empty string on end of line.
+    // ex. key = 1,2,3, <<< number of elements is 4. (1, 2, 3 and "")
+    const char* str_ptr = *ptr;
+    if (source->end < str_ptr) {
+        return 0;
+    }
+
+    CINI_IN_STRING value_str = { str_ptr, source->end };
+    for (; str_ptr < source->end && cini_in_isspace(*str_ptr); ++str_ptr) { }
+    if (str_ptr < source->end && cini_in_ischar(CINI_IN_QUOTE_CHARS, *str_ptr)) {
+        // Quoted: The separator after the closing quote (and white spaces) ends the element
+        // If the quote is not closed until the end of line, the first separator ends the element
+        char quote_chars[] = { CINI_IN_ARRAY_SEPARATOR, *str_ptr, '\0' };
+        CINI_IN_CHARSET set = cini_in_make_charset(quote_chars);
+        const char* separator = NULL;
+        const char* closing = NULL;
+        for (++str_ptr; (str_ptr = cini_in_scan(str_ptr, source->end, &set)) < source->end; ++str_ptr) {
+            if (*str_ptr != CINI_IN_ARRAY_SEPARATOR) {
+                closing = str_ptr;
+            } else if (closing != NULL && cini_in_isblank_range(closing + 1, str_ptr)) {
+                value_str.end = str_ptr;
+                break;
+            } else {
+                // The quote is reopened by the other character after the closing quote
+                closing = NULL;
+                if (separator == NULL) {
+                    separator = str_ptr;
                 }
             }
         }
+        if (str_ptr == source->end && separator != NULL && !(closing != NULL && cini_in_isblank_range(closing + 1, str_ptr))) {
+            value_str.end = separator;
+        }
+    } else {
+        const char* separator = (const char*)memchr(str_ptr, CINI_IN_ARRAY_SEPARATOR, source->end - str_ptr);
+        if (separator != NULL) {
+            value_str.end = separator;
+        }
     }
+
+    *element = value_str;
+    *ptr = value_str.end + 1;
+    return 1;
 }
 
-HCINI cini_in_create_handle(const char* path, const char* section)
+static void cini_in_split_array(CINI_IN_HANDLE* cini, CINI_IN_ENTRY* entry)
 {
-    CINI_IN_LIST memory_list = { NULL, NULL };
-    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)cini_in_allocate(&memory_list, sizeof(CINI_IN_HANDLE));
-    if (cini != NULL) {
-        cini->memory_list = memory_list;
-        cini->target_section_name = section;
-        FILE* file = cini_in_fopen(path, "r");
-        if (file != NULL) {
-            cini_in_parse(cini, file);
-            fclose(file);
-            file = NULL;
-        } else {
-            cini_in_error(cini, "Cannot open file");
-        }
+    // The number of separators + 1 is the upper limit of the number of elements
+    const CINI_IN_STRING* source = &entry->raw;
+    size_t capacity = 1;
+    for (const char* c = source->begin; (c = (const char*)memchr(c, CINI_IN_ARRAY_SEPARATOR, source->end - c)) != NULL; ++c) {
+        capacity += 1;
     }
-    return (HCINI)cini;
+    CINI_IN_VALUE* array = (CINI_IN_VALUE*)cini_in_allocate(&cini->arena, sizeof(CINI_IN_VALUE) * capacity);
+    if (array == NULL) {
+        // It is called by the getters, so the error is not recorded and the entry has no element
+        return;
+    }
+
+    int count = 0;
+    const char* ptr = source->begin;
+    CINI_IN_STRING element;
+    while (cini_in_next_element(&ptr, source, &element)) {
+        cini_in_set_value(&array[count++], &element);
+    }
+    entry->array = array;
+    entry->array_count = count;
+    cini->stats.value_count += count;
 }
 
-void cini_in_free_handle(HCINI hcini)
+static int cini_in_string_equals(const CINI_IN_STRING* str1, const CINI_IN_STRING* str2)
 {
-    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
-    if (cini != NULL) {
-        CINI_IN_LIST memory_list = cini->memory_list;
-        CINI_IN_LIST_NODE* node = (CINI_IN_LIST_NODE*)memory_list.front;
-        while (node != NULL) {
-            CINI_IN_LIST_NODE* next = node->next;
-            memset(node, 0, sizeof(CINI_IN_MEMORY));
-            CINI_FREE(node);
-            node = next;
+    size_t len = cini_in_string_len(str1);
+    return len == cini_in_string_len(str2) && memcmp(str1->begin, str2->begin, len) == 0;
+}
+
+static int cini_in_match_entry(CINI_IN_LIST_NODE* node, const void* data)
+{
+    const CINI_IN_ENTRY_KEY* key = (const CINI_IN_ENTRY_KEY*)data;
+    const CINI_IN_ENTRY* entry = (const CINI_IN_ENTRY*)node;
+    return entry->section == key->section && cini_in_string_equals(&key->name, &entry->name);
+}
+
+static int cini_in_match_section(CINI_IN_LIST_NODE* node, const void* data)
+{
+    return cini_in_string_equals((const CINI_IN_STRING*)data, &((CINI_IN_SECTION*)node)->name);
+}
+
+static int cini_in_match_interned(CINI_IN_LIST_NODE* node, const void* data)
+{
+    const CINI_IN_INTERNED* interned = (const CINI_IN_INTERNED*)node;
+    const CINI_IN_STRING* str = (const CINI_IN_STRING*)data;
+    return interned->len == cini_in_string_len(str) && memcmp(interned + 1, str->begin, interned->len) == 0;
+}
+
+static CINI_IN_INTERNED* cini_in_find_interned(const CINI_IN_HANDLE* cini, const CINI_IN_STRING* str)
+{
+    return (CINI_IN_INTERNED*)cini_in_index_find(&cini->string_index, cini_in_hash(CINI_IN_HASH_OFFSET_BASIS, str), cini_in_match_interned, str);
+}
+
+static CINI_IN_STRING cini_in_intern(CINI_IN_HANDLE* cini, const CINI_IN_STRING* str)
+{
+    // The result is null terminated, it is empty if the memory is exhausted
+    // The lazy handle is zero-copy and never interns, so the string index is not modified after it was created
+    CINI_IN_STRING interned_str = { "", "" };
+    size_t len = cini_in_string_len(str);
+    assert(!cini->lazy);
+    uint32_t hash = cini_in_hash(CINI_IN_HASH_OFFSET_BASIS, str);
+    CINI_IN_INTERNED* interned = (CINI_IN_INTERNED*)cini_in_index_find(&cini->string_index, hash, cini_in_match_interned, str);
+    if (interned != NULL) {
+        cini->shared_count += 1;
+        cini->saved_bytes += len + 1;
+    } else {
+        interned = (CINI_IN_INTERNED*)cini_in_allocate(&cini->arena, sizeof(CINI_IN_INTERNED) + len + 1);
+        if (interned == NULL) {
+            cini_in_error(cini, "Failed to allocate memory");
+            return interned_str;
         }
+        memset(&interned->node, 0, sizeof(interned->node));
+        interned->len = len;
+        memcpy(interned + 1, str->begin, len);
+        ((char*)(interned + 1))[len] = '\0';
+        cini_in_index_add(cini, &cini->string_index, hash, &interned->node);
     }
+    interned_str.begin = (const char*)(interned + 1);
+    interned_str.end = interned_str.begin + len;
+    return interned_str;
 }
 
-int cini_in_check_int(double f, int idefault)
+static CINI_IN_STRING cini_in_copy_string(CINI_IN_HANDLE* cini, void* dest, const CINI_IN_STRING* str)
 {
-    return (INT32_MIN <= f && f <= INT32_MAX) ? (int)f : idefault;
+    // The string is stored in the space after the node, or refers to the mapping in zero-copy mode
+    CINI_IN_STRING copied = *str;
+    if (!cini->zero_copy) {
+        size_t len = cini_in_string_len(str);
+        char* s = (char*)dest;
+        memcpy(s, str->begin, len);
+        copied.begin = s;
+        copied.end = s + len;
+    }
+    return copied;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-
-HCINI cini_create(const char* path)
+static size_t cini_in_string_size(const CINI_IN_HANDLE* cini, const CINI_IN_STRING* str)
 {
-    return cini_in_create_handle(path, NULL);
+    // The space after the node for cini_in_copy_string
+    return cini->zero_copy ? 0 : cini_in_string_len(str) + 1;
 }
 
-HCINI cini_create_with_section(const char* path, const char* section)
+static size_t cini_in_name_size(const CINI_IN_HANDLE* cini, const CINI_IN_STRING* name)
 {
-    return cini_in_create_handle(path, section);
+    return CINI_IN_INTERN ? 0 : cini_in_string_size(cini, name);
 }
 
-void cini_free(HCINI hcini)
+static CINI_IN_STRING cini_in_copy_name(CINI_IN_HANDLE* cini, void* dest, const CINI_IN_STRING* name)
 {
-    cini_in_free_handle(hcini);
+    // The names are interned because the same key names repeat in the sections
+    // The values are not, the cost of hashing them exceeds the saving for the unique values
+    return (!cini->zero_copy && CINI_IN_INTERN) ? cini_in_intern(cini, name) : cini_in_copy_string(cini, dest, name);
 }
 
-int cini_geti(HCINI hcini, const char* section, const char* key, int idefault)
+static CINI_IN_ENTRY* cini_in_add_entry(CINI_IN_HANDLE* cini, CINI_IN_SECTION* section, const CINI_IN_STRING* name, uint32_t hash, const CINI_IN_STRING* raw)
 {
-    const CINI_IN_VALUE* value = cini_in_get_value((CINI_IN_HANDLE*)hcini, section, key, 0);
-    return (value && !isnan(value->f)) ? cini_in_check_int(value->f, idefault) : idefault;
+    // Keep the raw value only, the array elements and the numeric are made at the first access
+    size_t name_size = cini_in_name_size(cini, name);
+    size_t size = sizeof(CINI_IN_ENTRY) + name_size + cini_in_string_size(cini, raw);
+    CINI_IN_ENTRY* entry = (CINI_IN_ENTRY*)cini_in_list_push_back(cini, &section->entry_list, size);
+    if (entry != NULL) {
+        entry->section = section;
+        entry->name = cini_in_copy_name(cini, entry + 1, name);
+        entry->s = cini->zero_copy ? NULL : entry->name.begin;
+        entry->raw = cini_in_copy_string(cini, (char*)(entry + 1) + name_size, raw);
+        cini_in_set_value(&entry->value, &entry->raw);
+        if (!cini->zero_copy && !(entry->value.flags & CINI_IN_VALUE_QUOTED)) {
+            // The copied raw value is null terminated
+            entry->value.s = entry->raw.begin;
+        }
+        cini_in_index_add(cini, cini->lazy ? &section->entry_index : &cini->entry_index, hash, &entry->node);
+        cini->stats.entry_count += 1;
+        cini->stats.value_count += 1;
+    }
+    return entry;
 }
 
-float cini_getf(HCINI hcini, const char* section, const char* key, float fdefault)
+static CINI_IN_SECTION* cini_in_add_section(CINI_IN_HANDLE* cini, const CINI_IN_STRING* name, uint32_t hash)
 {
-    const CINI_IN_VALUE* value = cini_in_get_value((CINI_IN_HANDLE*)hcini, section, key, 0);
-    return (value && !isnan(value->f)) ? (float)value->f : fdefault;
+    size_t size = sizeof(CINI_IN_SECTION) + cini_in_name_size(cini, name);
+    CINI_IN_SECTION* section = (CINI_IN_SECTION*)cini_in_list_push_back(cini, &cini->section_list, size);
+    if (section != NULL) {
+        section->name = cini_in_copy_name(cini, section + 1, name);
+        section->s = cini->zero_copy ? NULL : section->name.begin;
+        cini_in_index_add(cini, &cini->section_index, hash, &section->node);
+        cini->stats.section_count += 1;
+    }
+    return section;
 }
 
-const char* cini_gets(HCINI hcini, const char* section, const char* key, const char* sdefault)
+static CINI_IN_SECTION* cini_in_find_section(const CINI_IN_HANDLE* cini, const CINI_IN_STRING* name, uint32_t hash)
 {
-    const CINI_IN_VALUE* value = cini_in_get_value((CINI_IN_HANDLE*)hcini, section, key, 0);
-    return (value && value->s) ? value->s : sdefault;
+    return (CINI_IN_SECTION*)cini_in_index_find(&cini->section_index, hash, cini_in_match_section, name);
 }
 
-int cini_getai(HCINI hcini, const char* section, const char* key, int index_, int idefault)
+static CINI_IN_ENTRY* cini_in_find_entry(const CINI_IN_HANDLE* cini, const CINI_IN_SECTION* section, const CINI_IN_STRING* name, uint32_t hash)
 {
-    const CINI_IN_VALUE* value = (0 <= index_) ? cini_in_get_value((CINI_IN_HANDLE*)hcini, section, key, index_ + 1) : NULL;
-    return (value && !isnan(value->f)) ? cini_in_check_int(value->f, idefault) : idefault;
+    CINI_IN_ENTRY_KEY key = { section, *name };
+    return (CINI_IN_ENTRY*)cini_in_index_find(cini->lazy ? &section->entry_index : &cini->entry_index, hash, cini_in_match_entry, &key);
 }
-float cini_getaf(HCINI hcini, const char* section, const char* key, int index_, float fdefault)
+
+static CINI_KEY_DESC cini_in_make_desc(const char* section_name, const char* key_name)
 {
-    const CINI_IN_VALUE* value = (0 <= index_) ? cini_in_get_value((CINI_IN_HANDLE*)hcini, section, key, index_ + 1) : NULL;
-    return (value && !isnan(value->f)) ? (float)value->f : fdefault;
+    CINI_KEY_DESC desc = { section_name, strlen(section_name), key_name, strlen(key_name), 0, 0 };
+    CINI_IN_STRING section_name_str = { desc.section, desc.section + desc.section_len };
+    CINI_IN_STRING key_name_str = { desc.key, desc.key + desc.key_len };
+    desc.section_hash = cini_in_hash_section(&section_name_str);
+    desc.entry_hash = cini_in_hash_entry(desc.section_hash, &key_name_str);
+    return desc;
 }
-const char* cini_getas(HCINI hcini, const char* section, const char* key, int index_, const char* sdefault)
+
+static CINI_IN_ENTRY* cini_in_get_entry(CINI_IN_HANDLE* cini, const CINI_KEY_DESC* desc)
 {
-    const CINI_IN_VALUE* value = (0 <= index_) ? cini_in_get_value((CINI_IN_HANDLE*)hcini, section, key, index_ + 1) : NULL;
-    return (value && value->s) ? value->s : sdefault;
+    CINI_IN_STRING section_name_str = { desc->section, desc->section + desc->section_len };
+    CINI_IN_STRING key_name_str = { desc->key, desc->key + desc->key_len };
+    CINI_IN_SECTION* section = cini_in_find_section(cini, &section_name_str, desc->section_hash);
+    return (section) ? cini_in_find_entry(cini, cini_in_parse_section(cini, section), &key_name_str, desc->entry_hash) : NULL;
 }
 
-int cini_getcount(HCINI hcini, const char* section, const char* key)
+static void cini_in_lock(CINI_IN_LOCK* lock)
 {
-    const CINI_IN_ENTRY* entry = cini_in_get_entry((CINI_IN_HANDLE*)hcini, section, key);
-    return (entry) ? (cini_in_list_count(&entry->value_list) - 1) : 0;
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(lock);
+#else
+    pthread_mutex_lock(lock);
+#endif
 }
 
-int cini_geterrorcount(HCINI hcini)
+static void cini_in_unlock(CINI_IN_LOCK* lock)
 {
-    const CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
-    return (cini != NULL) ? cini_in_list_count(&cini->error_list) : 0;
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(lock);
+#else
+    pthread_mutex_unlock(lock);
+#endif
 }
 
-const char* cini_geterror(HCINI hcini, int index_)
+// Jobs shared by the worker threads, each thread takes the next index until the all of jobs are taken
+typedef struct {
+    void (*job_func)(void* data, int index_);
+    void* data;
+    int job_count;
+    int next;
+} CINI_IN_JOBS;
+
+static void cini_in_run_jobs(CINI_IN_JOBS* jobs)
+{
+    int index_;
+    while ((index_ = CINI_IN_FETCH_ADD_INT(&jobs->next, 1)) < jobs->job_count) {
+        jobs->job_func(jobs->data, index_);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI cini_in_thread_main(LPVOID arg)
+{
+    cini_in_run_jobs((CINI_IN_JOBS*)arg);
+    return 0;
+}
+#else
+static void* cini_in_thread_main(void* arg)
+{
+    cini_in_run_jobs((CINI_IN_JOBS*)arg);
+    return NULL;
+}
+#endif
+
+static int cini_in_start_thread(CINI_IN_THREAD* thread, CINI_IN_JOBS* jobs)
+{
+#if defined(_WIN32)
+    *thread = CreateThread(NULL, 0, cini_in_thread_main, jobs, 0, NULL);
+    return *thread != NULL;
+#else
+    return pthread_create(thread, NULL, cini_in_thread_main, jobs) == 0;
+#endif
+}
+
+static void cini_in_join_thread(CINI_IN_THREAD thread)
+{
+#if defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+static int cini_in_processor_count(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (0 < count) ? (int)count : 1;
+#endif
+}
+
+static void cini_in_run_parallel(CINI_IN_JOBS* jobs, int threads)
+{
+    // The calling thread works as one of the threads
+    // If a thread cannot be started, the jobs are done by the threads already running
+    int thread_count = (0 < threads) ? threads : cini_in_processor_count();
+    thread_count = (jobs->job_count < thread_count) ? jobs->job_count : thread_count;
+    CINI_IN_THREAD* thread_list = (1 < thread_count) ? (CINI_IN_THREAD*)CINI_MALLOC(sizeof(CINI_IN_THREAD) * (thread_count - 1)) : NULL;
+    int started = 0;
+    if (thread_list != NULL) {
+        while (started < thread_count - 1 && cini_in_start_thread(&thread_list[started], jobs)) {
+            ++started;
+        }
+    }
+    cini_in_run_jobs(jobs);
+    for (int i = 0; i < started; ++i) {
+        cini_in_join_thread(thread_list[i]);
+    }
+    CINI_FREE(thread_list);
+}
+
+// The lazy values are made under the lock at the first access and published by the release store
+// The readers which see the published flag or pointer never take the lock
+static CINI_IN_ENTRY* cini_in_entry_array(CINI_IN_HANDLE* cini, CINI_IN_ENTRY* entry)
+{
+    if (entry != NULL && !CINI_IN_LOAD_INT(&entry->array_split)) {
+        cini_in_lock(&cini->lock);
+        if (!entry->array_split) {
+            cini_in_split_array(cini, entry);
+            CINI_IN_STORE_INT(&entry->array_split, 1);
+        }
+        cini_in_unlock(&cini->lock);
+    }
+    return entry;
+}
+
+static CINI_IN_VALUE* cini_in_entry_value(CINI_IN_HANDLE* cini, CINI_IN_ENTRY* entry, int index_)
+{
+    // The index CINI_IN_WHOLE_VALUE refers to the whole value, the others refer to the array element
+    CINI_IN_VALUE* value = NULL;
+    if (entry == NULL) {
+        // Not found
+    } else if (index_ == CINI_IN_WHOLE_VALUE) {
+        value = &entry->value;
+    } else if (0 <= index_ && index_ < cini_in_entry_array(cini, entry)->array_count) {
+        value = &entry->array[index_];
+    }
+    return value;
+}
+
+static const CINI_IN_NUMBER* cini_in_value_numeric(CINI_IN_HANDLE* cini, CINI_IN_VALUE* value)
+{
+    if (!(CINI_IN_LOAD_INT(&value->flags) & CINI_IN_VALUE_CONVERTED)) {
+        cini_in_lock(&cini->lock);
+        if (!(value->flags & CINI_IN_VALUE_CONVERTED)) {
+            if (!(value->flags & CINI_IN_VALUE_QUOTED)) {
+#if CINI_IN_STATS_LOOKUP
+                uint64_t start = cini_in_now_ns();
+                value->number = cini_in_parse_number(&value->view);
+                cini->stats.number_ns += cini_in_now_ns() - start;
+#else
+                value->number = cini_in_parse_number(&value->view);
+#endif
+                cini->stats.number_count += 1;
+            }
+            CINI_IN_STORE_INT(&value->flags, value->flags | CINI_IN_VALUE_CONVERTED);
+        }
+        cini_in_unlock(&cini->lock);
+    }
+    return &value->number;
+}
+
+static const char* cini_in_lazy_string(CINI_IN_HANDLE* cini, const CINI_IN_STRING* view, const char** ptr)
+{
+    const char* s = (const char*)CINI_IN_LOAD_PTR(ptr);
+    if (s == NULL) {
+        // Zero-copy mode: Make the null terminated copy at the first access
+        cini_in_lock(&cini->lock);
+        s = *ptr;
+        if (s == NULL) {
+            size_t len = cini_in_string_len(view);
+            char* copied = (char*)cini_in_allocate(&cini->arena, len + 1);
+            if (copied != NULL) {
+                memcpy(copied, view->begin, len);
+                copied[len] = '\0';
+                CINI_IN_STORE_PTR(ptr, copied);
+            }
+            s = copied;
+        }
+        cini_in_unlock(&cini->lock);
+    }
+    return s;
+}
+
+static const char* cini_in_value_string(CINI_IN_HANDLE* cini, CINI_IN_VALUE* value)
+{
+    return cini_in_lazy_string(cini, &value->view, &value->s);
+}
+
+static int cini_in_is_target(const CINI_IN_PARSER* parser, const CINI_IN_STRING* section_name)
+{
+    int target = (parser->target_sections == NULL);
+    for (int i = 0; !target && i < parser->target_count; ++i) {
+        target = cini_in_string_equals(&parser->target_sections[i], section_name);
+    }
+    return target;
+}
+
+static void cini_in_enter_section(CINI_IN_PARSER* parser, const CINI_IN_STRING* section_name)
+{
+    if (parser->events != NULL) {
+        // Event mode: Nothing is stored
+    } else if (cini_in_is_target(parser, section_name)) {
+        uint32_t section_hash = cini_in_hash_section(section_name);
+        CINI_IN_SECTION* existing_section = cini_in_find_section(parser->cini, section_name, section_hash);
+        if (existing_section == NULL) {
+            parser->current_section = cini_in_add_section(parser->cini, section_name, section_hash);
+        } else {
+            parser->current_section = existing_section;
+        }
+        parser->current_section_hash = section_hash;
+        parser->skipping = 0;
+    } else {
+        // The lines until the next section are skipped by cini_in_skip_section
+        parser->current_section = NULL;
+        parser->skipping = 1;
+    }
+}
+
+static void cini_in_parse_begin(CINI_IN_PARSER* parser)
+{
+    // Default section
+    const char* default_name = "";
+    CINI_IN_STRING default_name_str = { default_name, default_name + strlen(default_name) };
+    cini_in_enter_section(parser, &default_name_str);
+}
+
+static int cini_in_count_lines(const char* begin, const char* end)
+{
+    int count = 0;
+    for (const char* c = begin; c < end; ++c) {
+        count += (*c == '\n');
+    }
+    return count;
+}
+
+static const char* cini_in_find_section_line(const char* begin, const char* end)
+{
+    // Find the next section line by '[' without trimming and parsing the lines in between
+    // The 'begin' must be the beginning of a line, the function returns the beginning of the section line or null
+    const char* ptr = begin;
+    const char* bracket = NULL;
+    while ((bracket = (const char*)memchr(ptr, CINI_IN_SECTION_BRACKET_OPEN, end - ptr)) != NULL) {
+        const char* line_begin = bracket;
+        while (begin < line_begin && line_begin[-1] != '\n' && cini_in_isspace(line_begin[-1])) {
+            --line_begin;
+        }
+        if (line_begin == begin || line_begin[-1] == '\n') {
+            return line_begin;
+        }
+        ptr = bracket + 1;
+    }
+    return NULL;
+}
+
+static const char* cini_in_skip_section(CINI_IN_PARSER* parser, const char* begin, const char* end)
+{
+    // The function returns the beginning of the line to parse next
+    const char* line_begin = cini_in_find_section_line(begin, end);
+    if (line_begin != NULL) {
+        parser->line_no += cini_in_count_lines(begin, line_begin);
+        parser->skipping = 0;
+        return line_begin;
+    }
+
+    // No section line: Skip the all of complete lines
+    const char* rest = end;
+    while (begin < rest && rest[-1] != '\n') {
+        --rest;
+    }
+    parser->line_no += cini_in_count_lines(begin, rest);
+    return rest;
+}
+
+static CINI_IN_STRING cini_in_section_name(const CINI_IN_STRING* line)
+{
+    // The 'line' is trimmed, the name is empty if it is invalid
+    CINI_IN_STRING section_name = { line->begin, line->begin };
+    if (line->begin < line->end && *line->begin == CINI_IN_SECTION_BRACKET_OPEN) {
+        section_name.begin = line->begin + 1;
+        section_name.end = (const char*)memchr(section_name.begin, CINI_IN_SECTION_BRACKET_CLOSE, line->end - section_name.begin);
+    }
+    return section_name;
+}
+
+static const char* cini_in_find_section_header(const char* begin, const char* end, CINI_IN_STRING* section_name)
+{
+    // Same as cini_in_find_section_line, but the invalid section lines are skipped as they do not change the current section
+    const char* line_begin = begin;
+    while ((line_begin = cini_in_find_section_line(line_begin, end)) != NULL) {
+        const char* line_end = (const char*)memchr(line_begin, '\n', end - line_begin);
+        CINI_IN_STRING line = { line_begin, (line_end != NULL) ? line_end : end };
+        line = cini_in_string_trim(&line);
+        *section_name = cini_in_section_name(&line);
+        if (cini_in_string_len(section_name) != 0) {
+            return line_begin;
+        }
+        line_begin = (line_end != NULL) ? line_end + 1 : end;
+    }
+    return NULL;
+}
+
+static void cini_in_parse_error(CINI_IN_PARSER* parser, const char* message)
+{
+    if (parser->events == NULL) {
+        cini_in_error(parser->cini, message);
+    } else if (parser->events->error != NULL && !parser->events->error(parser->user_data, message, parser->line_no)) {
+        parser->stopped = 1;
+    }
+}
+
+static void cini_in_emit_section(CINI_IN_PARSER* parser, const CINI_IN_STRING* section_name)
+{
+    const CINI_EVENTS* events = parser->events;
+    if (events->section != NULL && !events->section(parser->user_data, section_name->begin, cini_in_string_len(section_name), parser->line_no)) {
+        parser->stopped = 1;
+    }
+}
+
+static void cini_in_emit_entry(CINI_IN_PARSER* parser, const CINI_IN_STRING* key_name, const CINI_IN_STRING* raw, int has_value)
+{
+    // Same values as cini_in_add_entry and cini_in_split_array make, but on the stack
+    const CINI_EVENTS* events = parser->events;
+    CINI_IN_VALUE value;
+    cini_in_set_value(&value, raw);
+    if (events->key != NULL && !events->key(parser->user_data, key_name->begin, cini_in_string_len(key_name), parser->line_no)) {
+        parser->stopped = 1;
+    } else if (events->value != NULL && !events->value(parser->user_data, value.view.begin, cini_in_string_len(&value.view), value.flags & CINI_IN_VALUE_QUOTED)) {
+        parser->stopped = 1;
+    } else if (events->element != NULL && has_value) {
+        const char* ptr = raw->begin;
+        CINI_IN_STRING element;
+        for (int index_ = 0; !parser->stopped && cini_in_next_element(&ptr, raw, &element); ++index_) {
+            cini_in_set_value(&value, &element);
+            if (!events->element(parser->user_data, index_, value.view.begin, cini_in_string_len(&value.view), value.flags & CINI_IN_VALUE_QUOTED)) {
+                parser->stopped = 1;
+            }
+        }
+    }
+}
+
+static void cini_in_parse_line(CINI_IN_PARSER* parser, const CINI_IN_STRING* source)
+{
+    ++parser->line_no;
+    CINI_IN_STRING line = cini_in_string_trim(source);
+    if (cini_in_string_len(&line) == 0 || cini_in_ischar(CINI_IN_COMMENT_CHARS, *line.begin)) {
+        return;
+    }
+    if (*line.begin == CINI_IN_SECTION_BRACKET_OPEN) {
+        CINI_IN_STRING section_name = cini_in_section_name(&line);
+        if (cini_in_string_len(&section_name) == 0) {
+            cini_in_parse_error(parser, "Invalid section name");
+            return;
+        }
+        if (parser->events != NULL) {
+            cini_in_emit_section(parser, &section_name);
+        }
+        cini_in_enter_section(parser, &section_name);
+    } else {
+        if (parser->current_section != NULL || parser->events != NULL) {
+            CINI_IN_CHARSET assignment = cini_in_make_charset(CINI_IN_ASSIGNMENT_CHARS);
+            CINI_IN_STRING key_name = { line.begin, cini_in_scan(line.begin, line.end, &assignment) };
+            int has_value = (key_name.end < line.end);
+            CINI_IN_STRING value_str = { has_value ? (key_name.end + 1) : line.end, line.end };
+            key_name = cini_in_string_trim(&key_name);
+            if (cini_in_string_len(&key_name) == 0) {
+                cini_in_parse_error(parser, "Invalid key name");
+                return;
+            }
+            if (parser->events != NULL) {
+                value_str = cini_in_string_trim(&value_str);
+                cini_in_emit_entry(parser, &key_name, &value_str, has_value);
+                return;
+            }
+            uint32_t entry_hash = cini_in_hash_entry(parser->current_section_hash, &key_name);
+            CINI_IN_ENTRY* entry = cini_in_find_entry(parser->cini, parser->current_section, &key_name, entry_hash);
+            if (entry == NULL) {
+                value_str = cini_in_string_trim(&value_str);
+                entry = cini_in_add_entry(parser->cini, parser->current_section, &key_name, entry_hash, &value_str);
+                if (entry != NULL && !has_value) {
+                    // The key without assignment has an empty value and no array element
+                    entry->array_split = 1;
+                }
+            }
+        }
+    }
+}
+
+static const char* cini_in_parse_lines(CINI_IN_PARSER* parser, const char* begin, const char* end)
+{
+    // Parse the lines terminated by new-line and return the rest
+    const char* ptr = begin;
+    const char* newline = NULL;
+    for (;;) {
+        if (parser->skipping) {
+            ptr = cini_in_skip_section(parser, ptr, end);
+            if (parser->skipping) {
+                break;
+            }
+        }
+        if ((newline = (const char*)memchr(ptr, '\n', end - ptr)) == NULL) {
+            break;
+        }
+        CINI_IN_STRING line = { ptr, newline };
+        cini_in_parse_line(parser, &line);
+        ptr = newline + 1;
+        if (parser->stopped) {
+            break;
+        }
+    }
+    return ptr;
+}
+
+static void cini_in_parse_file(CINI_IN_PARSER* parser, FILE* file)
+{
+    // Read the file in blocks and carry the incomplete line over to the next block
+    // The buffer grows only if a line does not fit in it
+    size_t capacity = CINI_READ_BUFFER_SIZE;
+    const CINI_IN_ARENA* arena = &parser->cini->arena;
+    char* buffer = (char*)cini_in_arena_malloc(arena, capacity);
+    size_t filled = 0;
+    int first = 1;
+    if (buffer == NULL) {
+        cini_in_error(parser->cini, "Failed to allocate memory");
+        return;
+    }
+    cini_in_parse_begin(parser);
+    for (;;) {
+        uint64_t read_start = cini_in_now_ns();
+        size_t read_size = fread(buffer + filled, 1, capacity - filled, file);
+        parser->io_ns += cini_in_now_ns() - read_start;
+        parser->cini->stats.bytes_read += read_size;
+        int eof = (read_size < capacity - filled);
+        const char* end = buffer + filled + read_size;
+        const char* ptr = buffer;
+        if (first && 3 <= (size_t)(end - ptr)) {
+            ptr = cini_in_skip_bom(ptr);
+        }
+        first = 0;
+        ptr = cini_in_parse_lines(parser, ptr, end);
+        filled = end - ptr;
+        if (eof) {
+            if (0 < filled) {
+                CINI_IN_STRING line = { ptr, end };
+                cini_in_parse_line(parser, &line);
+            }
+            break;
+        }
+        if (ptr == buffer) {
+            char* new_buffer = (char*)cini_in_arena_malloc(arena, capacity * 2);
+            if (new_buffer == NULL) {
+                cini_in_error(parser->cini, "Failed to allocate memory");
+                break;
+            }
+            memcpy(new_buffer, buffer, filled);
+            cini_in_arena_free(arena, buffer);
+            buffer = new_buffer;
+            capacity *= 2;
+        } else {
+            memmove(buffer, ptr, filled);
+        }
+    }
+    cini_in_arena_free(arena, buffer);
+}
+
+static void cini_in_parse_range(CINI_IN_PARSER* parser, const char* begin, const char* end)
+{
+    // The last line may not be terminated by new-line
+    const char* ptr = cini_in_parse_lines(parser, begin, end);
+    if (ptr < end && !parser->stopped) {
+        CINI_IN_STRING line = { ptr, end };
+        cini_in_parse_line(parser, &line);
+    }
+}
+
+static void cini_in_parse_memory(CINI_IN_PARSER* parser, const char* data, size_t size)
+{
+    const char* end = data + size;
+    const char* ptr = (3 <= size) ? cini_in_skip_bom(data) : data;
+    if (parser->cini != NULL) {
+        parser->cini->stats.bytes_read += size;
+    }
+    cini_in_parse_begin(parser);
+    cini_in_parse_range(parser, ptr, end);
+}
+
+static int cini_in_map_file(CINI_IN_MAPPING* mapping, const char* path)
+{
+    static const char empty[] = "";
+    int mapped = 0;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart == 0) {
+            mapping->data = empty;
+            mapping->size = 0;
+            mapped = 1;
+        } else if (GetFileSizeEx(file, &size)) {
+            // The view keeps the mapping alive after closing the handles
+            HANDLE file_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (file_mapping != NULL) {
+                const char* data = (const char*)MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+                if (data != NULL) {
+                    mapping->data = data;
+                    mapping->size = (size_t)size.QuadPart;
+                    mapped = 1;
+                }
+                CloseHandle(file_mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (0 <= fd) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size == 0) {
+            mapping->data = empty;
+            mapping->size = 0;
+            mapped = 1;
+        } else if (fstat(fd, &st) == 0) {
+            void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                mapping->data = (const char*)data;
+                mapping->size = (size_t)st.st_size;
+                mapped = 1;
+            }
+        }
+        close(fd);
+    }
+#endif
+    return mapped;
+}
+
+static void cini_in_unmap_file(CINI_IN_MAPPING* mapping)
+{
+    if (mapping->data != NULL && 0 < mapping->size) {
+#if defined(_WIN32)
+        UnmapViewOfFile(mapping->data);
+#else
+        munmap((void*)mapping->data, mapping->size);
+#endif
+    }
+    mapping->data = NULL;
+    mapping->size = 0;
+}
+
+static int cini_in_stat(const char* path, uint64_t* size, int64_t* mtime)
+{
+    // The modification time is compared only for equality, so its unit depends on the platform
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+    *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    *mtime = (int64_t)(((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime);
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    *size = (uint64_t)st.st_size;
+#if defined(__APPLE__)
+    *mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(CINI_IN_POSIX_2008)
+    *mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    *mtime = (int64_t)st.st_mtime;
+#endif
+#endif
+    return 1;
+}
+
+static int cini_in_hash_file(const char* path, uint64_t* hash)
+{
+    // FNV-1a 64-bit of the file content
+    int hashed = 0;
+    char* buffer = (char*)CINI_MALLOC(CINI_READ_BUFFER_SIZE);
+    FILE* file = (buffer != NULL) ? cini_in_fopen(path, "rb") : NULL;
+    if (file != NULL) {
+        uint64_t h = CINI_IN_HASH64_OFFSET_BASIS;
+        size_t read_size = 0;
+        while ((read_size = fread(buffer, 1, CINI_READ_BUFFER_SIZE, file)) != 0) {
+            for (size_t i = 0; i < read_size; ++i) {
+                h = (h ^ (unsigned char)buffer[i]) * CINI_IN_HASH64_PRIME;
+            }
+        }
+        hashed = !ferror(file);
+        *hash = h;
+        fclose(file);
+    }
+    CINI_FREE(buffer);
+    return hashed;
+}
+
+static void cini_in_set_source(CINI_IN_HANDLE* cini, const char* path)
+{
+    // Record the source file to detect the modification, the size and the time stay 0 if the file does not exist
+    size_t len = strlen(path);
+    char* source_path = (char*)cini_in_allocate(&cini->arena, len + 1);
+    if (source_path != NULL) {
+        memcpy(source_path, path, len + 1);
+        cini->source_path = source_path;
+        if (!cini_in_stat(path, &cini->source_size, &cini->source_mtime)) {
+            cini->source_size = 0;
+            cini->source_mtime = 0;
+        }
+    }
+}
+
+static int cini_in_source_modified(const CINI_IN_HANDLE* cini)
+{
+    // The source which cannot be accessed now is not regarded as modified, the parsed data is still valid
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    return cini->source_path != NULL && cini_in_stat(cini->source_path, &size, &mtime) && (size != cini->source_size || mtime != cini->source_mtime);
+}
+
+static int cini_in_hash_source(const CINI_IN_HANDLE* cini, uint64_t* hash)
+{
+    // The source must be the same one as parsed, otherwise the compiled file would have the old data with the new hash
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    *hash = 0;
+    return cini->source_path == NULL || (cini_in_stat(cini->source_path, &size, &mtime) && !cini_in_source_modified(cini) && cini_in_hash_file(cini->source_path, hash));
+}
+
+static int cini_in_index_bits(size_t count)
+{
+    // Same load factor as cini_in_index_add
+    int bits = CINI_IN_INDEX_INITIAL_BITS;
+    while (((size_t)1 << bits) < count * 2) {
+        ++bits;
+    }
+    return bits;
+}
+
+static void cini_in_image_put(CINI_IN_IMAGE_SLOT* slots, int bits, uint32_t hash, uint32_t index)
+{
+    size_t mask = ((size_t)1 << bits) - 1;
+    size_t i = cini_in_index_home(bits, hash);
+    while (slots[i].index != 0) {
+        i = (i + 1) & mask;
+    }
+    slots[i].hash = hash;
+    slots[i].index = index + 1;
+}
+
+static void cini_in_image_set_number(CINI_IN_IMAGE_VALUE* image_value, const CINI_IN_NUMBER* number)
+{
+    image_value->f = number->f;
+    image_value->i = number->i;
+    image_value->number_flags = (uint32_t)number->flags;
+}
+
+typedef struct {
+    char* base;
+    size_t pos;
+    uint32_t* slots; // Offset of the string in the pool, 0 is empty
+    int bits;
+} CINI_IN_IMAGE_STRINGS;
+
+static uint32_t cini_in_image_add_string(CINI_IN_IMAGE_STRINGS* strings, const CINI_IN_STRING* str)
+{
+    // The same strings share one copy in the pool, the names repeated in the sections and the same values are stored once
+    size_t len = cini_in_string_len(str);
+    uint32_t offset = (uint32_t)strings->pos;
+    uint32_t* slot = NULL;
+    if (strings->slots != NULL) {
+        size_t mask = ((size_t)1 << strings->bits) - 1;
+        size_t i = cini_in_index_home(strings->bits, cini_in_hash(CINI_IN_HASH_OFFSET_BASIS, str));
+        for (; strings->slots[i] != 0; i = (i + 1) & mask) {
+            const char* found = strings->base + strings->slots[i];
+            if (strlen(found) == len && (len == 0 || memcmp(found, str->begin, len) == 0)) {
+                return strings->slots[i];
+            }
+        }
+        slot = &strings->slots[i];
+    }
+    if (0 < len) {
+        memcpy(strings->base + strings->pos, str->begin, len);
+    }
+    strings->base[strings->pos + len] = '\0';
+    strings->pos += len + 1;
+    if (slot != NULL) {
+        *slot = offset;
+    }
+    return offset;
+}
+
+static char* cini_in_build_image(CINI_IN_HANDLE* cini, uint64_t source_hash, size_t* image_size)
+{
+    // First pass: Count the records and the size of the string pool
+    // The arrays are split and the numerics are converted here, so the loader does nothing but mapping
+    const char* source_path = (cini->source_path != NULL) ? cini->source_path : "";
+    CINI_IN_STRING source_path_str = { source_path, source_path + strlen(source_path) };
+    size_t section_count = 0;
+    size_t entry_count = 0;
+    size_t value_count = 0;
+    size_t error_count = 0;
+    size_t string_count = 1;
+    size_t strings_size = cini_in_string_len(&source_path_str) + 1;
+    for (CINI_IN_LIST_NODE* section_node = cini->section_list.front; section_node != NULL; section_node = section_node->next) {
+        const CINI_IN_SECTION* section = cini_in_parse_section(cini, (CINI_IN_SECTION*)section_node);
+        section_count += 1;
+        string_count += 1;
+        strings_size += cini_in_string_len(&section->name) + 1;
+        for (CINI_IN_LIST_NODE* entry_node = section->entry_list.front; entry_node != NULL; entry_node = entry_node->next) {
+            const CINI_IN_ENTRY* entry = cini_in_entry_array(cini, (CINI_IN_ENTRY*)entry_node);
+            entry_count += 1;
+            value_count += entry->array_count;
+            string_count += 2 + entry->array_count;
+            strings_size += cini_in_string_len(&entry->name) + 1 + cini_in_string_len(&entry->value.view) + 1;
+            for (int i = 0; i < entry->array_count; ++i) {
+                strings_size += cini_in_string_len(&entry->array[i].view) + 1;
+            }
+        }
+    }
+    for (CINI_IN_LIST_NODE* error_node = cini->error_list.front; error_node != NULL; error_node = error_node->next) {
+        error_count += 1;
+        string_count += 1;
+        strings_size += strlen(((const CINI_IN_ERROR*)error_node)->message) + 1;
+    }
+
+    int section_bits = cini_in_index_bits(section_count);
+    int entry_bits = cini_in_index_bits(entry_count);
+    size_t sections_offset = cini_in_align(sizeof(CINI_IN_IMAGE_HEADER));
+    size_t entries_offset = cini_in_align(sections_offset + sizeof(CINI_IN_IMAGE_SECTION) * section_count);
+    size_t values_offset = cini_in_align(entries_offset + sizeof(CINI_IN_IMAGE_ENTRY) * entry_count);
+    size_t section_index_offset = cini_in_align(values_offset + sizeof(CINI_IN_IMAGE_VALUE) * value_count);
+    size_t entry_index_offset = cini_in_align(section_index_offset + (sizeof(CINI_IN_IMAGE_SLOT) << section_bits));
+    size_t errors_offset = cini_in_align(entry_index_offset + (sizeof(CINI_IN_IMAGE_SLOT) << entry_bits));
+    size_t strings_offset = cini_in_align(errors_offset + sizeof(uint32_t) * error_count);
+    size_t size = strings_offset + strings_size;
+    if ((size_t)UINT32_MAX < size) {
+        // The offsets are 32-bit
+        return NULL;
+    }
+    char* base = (char*)cini_in_arena_malloc(&cini->arena, size);
+    CINI_IN_IMAGE_STRINGS strings = { base, strings_offset, NULL, cini_in_index_bits(string_count) };
+    if (base == NULL) {
+        return NULL;
+    }
+    memset(base, 0, size);
+    // The strings are stored without sharing if the table cannot be allocated
+    strings.slots = (uint32_t*)cini_in_arena_malloc(&cini->arena, sizeof(uint32_t) << strings.bits);
+    if (strings.slots != NULL) {
+        memset(strings.slots, 0, sizeof(uint32_t) << strings.bits);
+    }
+
+    // Second pass: Fill the tables
+    CINI_IN_IMAGE_HEADER* header = (CINI_IN_IMAGE_HEADER*)base;
+    CINI_IN_IMAGE_SECTION* sections = (CINI_IN_IMAGE_SECTION*)(base + sections_offset);
+    CINI_IN_IMAGE_ENTRY* entries = (CINI_IN_IMAGE_ENTRY*)(base + entries_offset);
+    CINI_IN_IMAGE_VALUE* values = (CINI_IN_IMAGE_VALUE*)(base + values_offset);
+    CINI_IN_IMAGE_SLOT* section_slots = (CINI_IN_IMAGE_SLOT*)(base + section_index_offset);
+    CINI_IN_IMAGE_SLOT* entry_slots = (CINI_IN_IMAGE_SLOT*)(base + entry_index_offset);
+    uint32_t* errors = (uint32_t*)(base + errors_offset);
+    memcpy(header->magic, CINI_IN_IMAGE_MAGIC, sizeof(header->magic));
+    header->version = CINI_IN_IMAGE_VERSION;
+    header->byte_order = CINI_IN_IMAGE_BYTE_ORDER;
+    header->source_size = cini->source_size;
+    header->source_mtime = cini->source_mtime;
+    header->source_hash = source_hash;
+    header->source_path = cini_in_image_add_string(&strings, &source_path_str);
+    header->section_count = (uint32_t)section_count;
+    header->sections = (uint32_t)sections_offset;
+    header->entry_count = (uint32_t)entry_count;
+    header->entries = (uint32_t)entries_offset;
+    header->value_count = (uint32_t)value_count;
+    header->values = (uint32_t)values_offset;
+    header->section_index_bits = (uint32_t)section_bits;
+    header->section_index = (uint32_t)section_index_offset;
+    header->entry_index_bits = (uint32_t)entry_bits;
+    header->entry_index = (uint32_t)entry_index_offset;
+    header->error_count = (uint32_t)error_count;
+    header->errors = (uint32_t)errors_offset;
+    header->strings = (uint32_t)strings_offset;
+
+    uint32_t section_index = 0;
+    uint32_t entry_index = 0;
+    uint32_t value_index = 0;
+    for (CINI_IN_LIST_NODE* section_node = cini->section_list.front; section_node != NULL; section_node = section_node->next, ++section_index) {
+        const CINI_IN_SECTION* section = (const CINI_IN_SECTION*)section_node;
+        uint32_t section_hash = cini_in_hash_section(&section->name);
+        CINI_IN_IMAGE_SECTION* image_section = &sections[section_index];
+        image_section->name = cini_in_image_add_string(&strings, &section->name);
+        image_section->name_len = (uint32_t)cini_in_string_len(&section->name);
+        image_section->entries = entry_index;
+        cini_in_image_put(section_slots, section_bits, section_hash, section_index);
+        for (CINI_IN_LIST_NODE* entry_node = section->entry_list.front; entry_node != NULL; entry_node = entry_node->next, ++entry_index) {
+            CINI_IN_ENTRY* entry = (CINI_IN_ENTRY*)entry_node;
+            CINI_IN_IMAGE_ENTRY* image_entry = &entries[entry_index];
+            cini_in_image_set_number(&image_entry->value, cini_in_value_numeric(cini, &entry->value));
+            image_entry->value.s = cini_in_image_add_string(&strings, &entry->value.view);
+            image_entry->name = cini_in_image_add_string(&strings, &entry->name);
+            image_entry->name_len = (uint32_t)cini_in_string_len(&entry->name);
+            image_entry->section = section_index;
+            image_entry->elements = value_index;
+            image_entry->element_count = (uint32_t)entry->array_count;
+            for (int i = 0; i < entry->array_count; ++i, ++value_index) {
+                cini_in_image_set_number(&values[value_index], cini_in_value_numeric(cini, &entry->array[i]));
+                values[value_index].s = cini_in_image_add_string(&strings, &entry->array[i].view);
+            }
+            cini_in_image_put(entry_slots, entry_bits, cini_in_hash_entry(section_hash, &entry->name), entry_index);
+        }
+        image_section->entry_count = entry_index - image_section->entries;
+    }
+    uint32_t error_index = 0;
+    for (CINI_IN_LIST_NODE* error_node = cini->error_list.front; error_node != NULL; error_node = error_node->next, ++error_index) {
+        const char* message = ((const CINI_IN_ERROR*)error_node)->message;
+        CINI_IN_STRING message_str = { message, message + strlen(message) };
+        errors[error_index] = cini_in_image_add_string(&strings, &message_str);
+    }
+    // The size is fixed after the shared strings were removed
+    assert(strings.pos <= size);
+    cini_in_arena_free(&cini->arena, strings.slots);
+    header->size = (uint32_t)strings.pos;
+    header->strings_size = (uint32_t)(strings.pos - strings_offset);
+    *image_size = strings.pos;
+    return base;
+}
+
+static int cini_in_write_file(const char* path, const char* data, size_t size)
+{
+    // Write to the temporary file and replace, so that the loader never sees the partially written file
+    size_t path_len = strlen(path);
+    char* temp_path = (char*)CINI_MALLOC(path_len + 5);
+    int written = 0;
+    if (temp_path != NULL) {
+        memcpy(temp_path, path, path_len);
+        memcpy(temp_path + path_len, ".tmp", 5);
+        FILE* file = cini_in_fopen(temp_path, "wb");
+        if (file != NULL) {
+            written = (fwrite(data, 1, size, file) == size);
+            written = (fclose(file) == 0) && written;
+            if (written) {
+#if defined(_WIN32)
+                written = (MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+                written = (rename(temp_path, path) == 0);
+#endif
+            }
+            if (!written) {
+                remove(temp_path);
+            }
+        }
+        CINI_FREE(temp_path);
+    }
+    return written;
+}
+
+static int cini_in_image_table(const CINI_IN_IMAGE_HEADER* header, uint32_t offset, uint64_t count, size_t record_size)
+{
+    return (offset % CINI_IN_MEMORY_ALIGNMENT) == 0 && sizeof(CINI_IN_IMAGE_HEADER) <= offset && (uint64_t)offset + count * record_size <= header->size;
+}
+
+static int cini_in_load_image(CINI_IN_IMAGE* image, const char* data, size_t size)
+{
+    // Validate the header and the table bounds, the records are validated when they are accessed
+    const CINI_IN_IMAGE_HEADER* header = (const CINI_IN_IMAGE_HEADER*)data;
+    int valid = sizeof(CINI_IN_IMAGE_HEADER) <= size
+        && memcmp(header->magic, CINI_IN_IMAGE_MAGIC, sizeof(header->magic)) == 0
+        && header->version == CINI_IN_IMAGE_VERSION
+        && header->byte_order == CINI_IN_IMAGE_BYTE_ORDER
+        && header->size == size
+        && 0 < header->section_index_bits && header->section_index_bits < 32
+        && 0 < header->entry_index_bits && header->entry_index_bits < 32
+        && cini_in_image_table(header, header->sections, header->section_count, sizeof(CINI_IN_IMAGE_SECTION))
+        && cini_in_image_table(header, header->entries, header->entry_count, sizeof(CINI_IN_IMAGE_ENTRY))
+        && cini_in_image_table(header, header->values, header->value_count, sizeof(CINI_IN_IMAGE_VALUE))
+        && cini_in_image_table(header, header->section_index, (uint64_t)1 << header->section_index_bits, sizeof(CINI_IN_IMAGE_SLOT))
+        && cini_in_image_table(header, header->entry_index, (uint64_t)1 << header->entry_index_bits, sizeof(CINI_IN_IMAGE_SLOT))
+        && cini_in_image_table(header, header->errors, header->error_count, sizeof(uint32_t))
+        && sizeof(CINI_IN_IMAGE_HEADER) <= header->strings && 0 < header->strings_size
+        && (uint64_t)header->strings + header->strings_size <= size
+        && data[header->strings + header->strings_size - 1] == '\0';
+    if (valid) {
+        image->base = data;
+        image->header = header;
+        image->sections = (const CINI_IN_IMAGE_SECTION*)(data + header->sections);
+        image->entries = (const CINI_IN_IMAGE_ENTRY*)(data + header->entries);
+        image->values = (const CINI_IN_IMAGE_VALUE*)(data + header->values);
+        image->section_slots = (const CINI_IN_IMAGE_SLOT*)(data + header->section_index);
+        image->entry_slots = (const CINI_IN_IMAGE_SLOT*)(data + header->entry_index);
+        image->errors = (const uint32_t*)(data + header->errors);
+    }
+    return valid;
+}
+
+static const char* cini_in_image_string(const CINI_IN_IMAGE* image, uint32_t offset, uint32_t len)
+{
+    // The string and the terminator must be in the string pool
+    const CINI_IN_IMAGE_HEADER* header = image->header;
+    return (header->strings <= offset && (uint64_t)offset + len < (uint64_t)header->strings + header->strings_size) ? (image->base + offset) : NULL;
+}
+
+static int cini_in_image_check_source(const CINI_IN_IMAGE* image)
+{
+    // The compiled file is used as is if the source does not exist, it can be deployed without the source
+    // Otherwise the content hash is compared only if the modification time was changed
+    const CINI_IN_IMAGE_HEADER* header = image->header;
+    const char* source_path = cini_in_image_string(image, header->source_path, 0);
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+    if (source_path == NULL) {
+        return 0;
+    }
+    if (*source_path == '\0' || !cini_in_stat(source_path, &size, &mtime)) {
+        return 1;
+    }
+    return size == header->source_size && (mtime == header->source_mtime || (cini_in_hash_file(source_path, &hash) && hash == header->source_hash));
+}
+
+static int cini_in_image_name_equals(const CINI_IN_IMAGE* image, uint32_t name, uint32_t name_len, const CINI_IN_STRING* str)
+{
+    const char* s = cini_in_image_string(image, name, name_len);
+    return s != NULL && name_len == cini_in_string_len(str) && memcmp(s, str->begin, name_len) == 0;
+}
+
+static int cini_in_image_match_section(const CINI_IN_IMAGE* image, uint32_t index, const void* data)
+{
+    return index < image->header->section_count && cini_in_image_name_equals(image, image->sections[index].name, image->sections[index].name_len, (const CINI_IN_STRING*)data);
+}
+
+static int cini_in_image_match_entry(const CINI_IN_IMAGE* image, uint32_t index, const void* data)
+{
+    const CINI_IN_IMAGE_ENTRY_KEY* key = (const CINI_IN_IMAGE_ENTRY_KEY*)data;
+    return index < image->header->entry_count && image->entries[index].section == key->section
+        && cini_in_image_name_equals(image, image->entries[index].name, image->entries[index].name_len, &key->name);
+}
+
+static uint32_t cini_in_image_find(const CINI_IN_IMAGE* image, const CINI_IN_IMAGE_SLOT* slots, uint32_t bits, uint32_t hash,
+    int (*match_func)(const CINI_IN_IMAGE*, uint32_t, const void*), const void* data)
+{
+    // Same probing as cini_in_index_find, but it stops after visiting all slots in case the file is broken
+    size_t mask = ((size_t)1 << bits) - 1;
+    size_t i = cini_in_index_home((int)bits, hash);
+    for (size_t n = 0; n <= mask && slots[i].index != 0; ++n, i = (i + 1) & mask) {
+        if (slots[i].hash == hash && match_func(image, slots[i].index - 1, data)) {
+            return slots[i].index;
+        }
+    }
+    return 0;
+}
+
+static const CINI_IN_IMAGE_ENTRY* cini_in_image_get_entry(const CINI_IN_IMAGE* image, const CINI_KEY_DESC* desc)
+{
+    CINI_IN_STRING section_name_str = { desc->section, desc->section + desc->section_len };
+    CINI_IN_IMAGE_ENTRY_KEY key = { 0, { desc->key, desc->key + desc->key_len } };
+    const CINI_IN_IMAGE_HEADER* header = image->header;
+    uint32_t section = cini_in_image_find(image, image->section_slots, header->section_index_bits, desc->section_hash, cini_in_image_match_section, &section_name_str);
+    uint32_t entry = 0;
+    if (section != 0) {
+        key.section = section - 1;
+        entry = cini_in_image_find(image, image->entry_slots, header->entry_index_bits, desc->entry_hash, cini_in_image_match_entry, &key);
+    }
+    return (entry != 0) ? &image->entries[entry - 1] : NULL;
+}
+
+static int cini_in_image_count(const CINI_IN_IMAGE* image, const CINI_IN_IMAGE_ENTRY* entry)
+{
+    return ((uint64_t)entry->elements + entry->element_count <= image->header->value_count) ? (int)entry->element_count : 0;
+}
+
+static const CINI_IN_IMAGE_VALUE* cini_in_image_value(const CINI_IN_IMAGE* image, const CINI_IN_IMAGE_ENTRY* entry, int index_)
+{
+    const CINI_IN_IMAGE_VALUE* value = NULL;
+    if (entry == NULL) {
+        // Not found
+    } else if (index_ == CINI_IN_WHOLE_VALUE) {
+        value = &entry->value;
+    } else if (0 <= index_ && index_ < cini_in_image_count(image, entry)) {
+        value = &image->values[entry->elements + index_];
+    }
+    return value;
+}
+
+static CINI_IN_HANDLE* cini_in_new_handle(const CINI_ALLOCATOR* allocator)
+{
+    CINI_IN_ARENA arena;
+    CINI_IN_HANDLE* cini = NULL;
+    cini_in_init_arena(&arena, allocator);
+    cini = (CINI_IN_HANDLE*)cini_in_allocate(&arena, sizeof(CINI_IN_HANDLE));
+    if (cini != NULL) {
+        memset(cini, 0, sizeof(CINI_IN_HANDLE));
+        cini->arena = arena;
+#if defined(_WIN32)
+        InitializeSRWLock(&cini->lock);
+#else
+        pthread_mutex_init(&cini->lock, NULL);
+#endif
+    }
+    return cini;
+}
+
+static void cini_in_init_parser(CINI_IN_PARSER* parser, CINI_IN_HANDLE* cini, const char* const* sections, int count)
+{
+    memset(parser, 0, sizeof(CINI_IN_PARSER));
+    parser->cini = cini;
+    parser->start_ns = cini_in_now_ns();
+    cini->parser = parser;
+    if (sections != NULL) {
+        // Only refer to the names, they are used while parsing
+        CINI_IN_STRING* target_sections = (CINI_IN_STRING*)cini_in_allocate(&cini->arena, sizeof(CINI_IN_STRING) * (count + 1));
+        if (target_sections != NULL) {
+            for (int i = 0; i < count; ++i) {
+                target_sections[i].begin = sections[i];
+                target_sections[i].end = sections[i] + strlen(sections[i]);
+            }
+            parser->target_sections = target_sections;
+            parser->target_count = count;
+        }
+        cini->filtered = 1;
+    }
+}
+
+static void cini_in_term_parser(CINI_IN_PARSER* parser)
+{
+    CINI_IN_STATS* stats = &parser->cini->stats;
+    uint64_t elapsed = cini_in_now_ns() - parser->start_ns;
+    stats->line_count += (size_t)parser->line_no;
+    stats->io_ns += parser->io_ns;
+    stats->tokenize_ns += (parser->io_ns < elapsed) ? elapsed - parser->io_ns : 0;
+    parser->cini->parser = NULL;
+}
+
+HCINI cini_in_create_handle(const char* path, const char* const* sections, int count, const CINI_ALLOCATOR* allocator)
+{
+    CINI_IN_HANDLE* cini = cini_in_new_handle(allocator);
+    if (cini != NULL) {
+        CINI_IN_PARSER parser;
+        FILE* file = NULL;
+        cini_in_init_parser(&parser, cini, sections, count);
+        file = cini_in_fopen(path, "rb");
+        parser.io_ns += cini_in_now_ns() - parser.start_ns;
+        cini_in_set_source(cini, path);
+        if (file != NULL) {
+            cini_in_parse_file(&parser, file);
+            fclose(file);
+            file = NULL;
+        } else {
+            cini_in_error(cini, "Cannot open file");
+        }
+        cini_in_term_parser(&parser);
+    }
+    return (HCINI)cini;
+}
+
+typedef struct {
+    const char* const* paths;
+    HCINI* out_handles;
+} CINI_IN_MANY;
+
+static void cini_in_create_many_job(void* data, int index_)
+{
+    CINI_IN_MANY* many = (CINI_IN_MANY*)data;
+    many->out_handles[index_] = cini_in_create_handle(many->paths[index_], NULL, 0, NULL);
+}
+
+int cini_in_create_handles(const char* const* paths, int count, HCINI* out_handles, int threads)
+{
+    // Each file is parsed into its own handle, so the threads share nothing but the job counter
+    CINI_IN_MANY many = { paths, out_handles };
+    CINI_IN_JOBS jobs = { cini_in_create_many_job, &many, count, 0 };
+    int created = 0;
+    if (paths == NULL || out_handles == NULL || count <= 0) {
+        return 0;
+    }
+    cini_in_run_parallel(&jobs, threads);
+    for (int i = 0; i < count; ++i) {
+        created += (out_handles[i] != NULL);
+    }
+    return created;
+}
+
+HCINI cini_in_create_handle_buffer(const char* data, size_t len, const char* const* sections, int count)
+{
+    CINI_IN_HANDLE* cini = cini_in_new_handle(NULL);
+    if (cini != NULL) {
+        CINI_IN_PARSER parser;
+        cini_in_init_parser(&parser, cini, sections, count);
+        cini_in_parse_memory(&parser, (data != NULL) ? data : "", (data != NULL) ? len : 0);
+        cini_in_term_parser(&parser);
+    }
+    return (HCINI)cini;
+}
+
+HCINI cini_in_create_handle_mmap(const char* path, const char* const* sections, int count)
+{
+    CINI_IN_HANDLE* cini = cini_in_new_handle(NULL);
+    if (cini != NULL) {
+        CINI_IN_PARSER parser;
+        cini_in_init_parser(&parser, cini, sections, count);
+        cini_in_set_source(cini, path);
+        if (cini_in_map_file(&cini->mapping, path)) {
+            parser.io_ns += cini_in_now_ns() - parser.start_ns;
+            cini->zero_copy = 1;
+            cini_in_parse_memory(&parser, cini->mapping.data, cini->mapping.size);
+        } else {
+            cini_in_error(cini, "Cannot open file");
+        }
+        cini_in_term_parser(&parser);
+    }
+    return (HCINI)cini;
+}
+
+static CINI_IN_RANGE* cini_in_add_range(CINI_IN_HANDLE* cini, CINI_IN_SECTION* section, const char* begin)
+{
+    // The range is closed by the next one or the end of the file
+    CINI_IN_RANGE* range = (CINI_IN_RANGE*)cini_in_list_push_back(cini, &cini->range_list, sizeof(CINI_IN_RANGE));
+    if (range != NULL) {
+        range->begin = begin;
+        range->end = begin;
+        range->line_no = -1;
+        if (section->range_back != NULL) {
+            section->range_back->next = range;
+        } else {
+            section->range_front = range;
+        }
+        section->range_back = range;
+    }
+    return range;
+}
+
+static int cini_in_range_line_no(CINI_IN_HANDLE* cini, CINI_IN_RANGE* range)
+{
+    // The line numbers are counted only up to the range parsed, the ranges before 'counted_range' are counted
+    while (range->line_no < 0 && cini->counted_range != NULL && cini->counted_range->node.next != NULL) {
+        CINI_IN_RANGE* counted = cini->counted_range;
+        CINI_IN_RANGE* next = (CINI_IN_RANGE*)counted->node.next;
+        next->line_no = counted->line_no + cini_in_count_lines(counted->begin, counted->end);
+        cini->counted_range = next;
+    }
+    return (0 <= range->line_no) ? range->line_no : 0;
+}
+
+static CINI_IN_SECTION* cini_in_parse_section(CINI_IN_HANDLE* cini, CINI_IN_SECTION* section)
+{
+    // Parse the ranges of the section at the first access, the section is complete once 'parsed' is set
+    if (cini->lazy && !CINI_IN_LOAD_INT(&section->parsed)) {
+        cini_in_lock(&cini->lock);
+        if (!section->parsed) {
+            for (CINI_IN_RANGE* range = section->range_front; range != NULL; range = range->next) {
+                CINI_IN_PARSER parser;
+                int line_no = cini_in_range_line_no(cini, range);
+                cini_in_init_parser(&parser, cini, NULL, 0);
+                parser.current_section = section;
+                parser.current_section_hash = cini_in_hash_section(&section->name);
+                parser.line_no = line_no;
+                cini->stats.bytes_read += range->end - range->begin;
+                cini_in_parse_range(&parser, range->begin, range->end);
+                cini_in_term_parser(&parser);
+                cini->stats.line_count -= (size_t)line_no;
+            }
+            CINI_IN_STORE_INT(&section->parsed, 1);
+        }
+        cini_in_unlock(&cini->lock);
+    }
+    return section;
+}
+
+HCINI cini_in_create_handle_lazy(const char* path)
+{
+    // Find the section lines without parsing the lines in between, the sections are parsed by cini_in_parse_section
+    CINI_IN_HANDLE* cini = cini_in_new_handle(NULL);
+    uint64_t start = cini_in_now_ns();
+    if (cini != NULL) {
+        cini_in_set_source(cini, path);
+        if (cini_in_map_file(&cini->mapping, path)) {
+            const char* end = cini->mapping.data + cini->mapping.size;
+            const char* ptr = (3 <= cini->mapping.size) ? cini_in_skip_bom(cini->mapping.data) : cini->mapping.data;
+            const char* default_name = "";
+            CINI_IN_STRING default_name_str = { default_name, default_name };
+            CINI_IN_SECTION* section = NULL;
+            CINI_IN_RANGE* range = NULL;
+            cini->stats.io_ns = cini_in_now_ns() - start;
+            cini->zero_copy = 1;
+            cini->lazy = 1;
+            cini->stats.bytes_read = ptr - cini->mapping.data; // The ranges do not have the BOM
+            section = cini_in_add_section(cini, &default_name_str, cini_in_hash_section(&default_name_str));
+            range = (section != NULL) ? cini_in_add_range(cini, section, ptr) : NULL;
+            if (range != NULL) {
+                range->line_no = 0;
+                cini->counted_range = range;
+            }
+            // The invalid section line stays in the current range, its error is recorded when it is parsed
+            CINI_IN_STRING section_name;
+            while (range != NULL && (ptr = cini_in_find_section_header(ptr, end, &section_name)) != NULL) {
+                const char* line_end = (const char*)memchr(ptr, '\n', end - ptr);
+                uint32_t section_hash = cini_in_hash_section(&section_name);
+                section = cini_in_find_section(cini, &section_name, section_hash);
+                section = (section != NULL) ? section : cini_in_add_section(cini, &section_name, section_hash);
+                range->end = ptr;
+                range = (section != NULL) ? cini_in_add_range(cini, section, ptr) : NULL;
+                ptr = (line_end != NULL) ? line_end + 1 : end;
+            }
+            if (range != NULL) {
+                range->end = end;
+            }
+            cini->stats.tokenize_ns = cini_in_now_ns() - start - cini->stats.io_ns;
+        } else {
+            cini_in_error(cini, "Cannot open file");
+        }
+    }
+    return (HCINI)cini;
+}
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    int line_no;          // The number of lines before the chunk
+    CINI_IN_HANDLE* cini; // The handle which the chunk is parsed into
+} CINI_IN_CHUNK;
+
+static void cini_in_count_chunk_job(void* data, int index_)
+{
+    CINI_IN_CHUNK* chunk = &((CINI_IN_CHUNK*)data)[index_];
+    chunk->line_no = cini_in_count_lines(chunk->begin, chunk->end);
+}
+
+static void cini_in_parse_chunk_job(void* data, int index_)
+{
+    // The first chunk is parsed into the main handle, the others into their own handles
+    CINI_IN_CHUNK* chunk = &((CINI_IN_CHUNK*)data)[index_];
+    CINI_IN_PARSER parser;
+    if (chunk->cini == NULL) {
+        chunk->cini = cini_in_new_handle(NULL);
+        if (chunk->cini == NULL) {
+            return;
+        }
+        chunk->cini->zero_copy = 1;
+    }
+    cini_in_init_parser(&parser, chunk->cini, NULL, 0);
+    parser.line_no = chunk->line_no;
+    cini_in_parse_memory(&parser, chunk->begin, chunk->end - chunk->begin);
+    cini_in_term_parser(&parser);
+    // Count only the lines of the chunk
+    chunk->cini->stats.line_count -= (size_t)chunk->line_no;
+}
+
+static void cini_in_merge_handle(CINI_IN_HANDLE* cini, CINI_IN_HANDLE* part)
+{
+    // Move the sections of 'part' into 'cini' as if they were parsed after the existing ones
+    // The duplicate section is merged into the existing one, and the first entry of the same key is kept
+    CINI_IN_LIST_NODE* section_node = part->section_list.front;
+    CINI_IN_LIST_NODE* error_node = part->error_list.front;
+#if !defined(_WIN32)
+    pthread_mutex_destroy(&part->lock);
+#endif
+    // The memory of 'part' including itself is released together with 'cini'
+    // Both are created with the default allocator
+    cini->arena.allocated += part->arena.allocated;
+    cini->arena.chunk_count += part->arena.chunk_count;
+    cini->arena.wasted_bytes += part->arena.wasted_bytes;
+    cini->arena.released_bytes += part->arena.released_bytes;
+    cini->stats.bytes_read += part->stats.bytes_read;
+    cini->stats.line_count += part->stats.line_count;
+    cini->stats.section_count += part->stats.section_count;
+    cini->stats.entry_count += part->stats.entry_count;
+    cini->stats.value_count += part->stats.value_count;
+    if (part->arena.list.front != NULL) {
+        part->arena.list.back->next = cini->arena.list.front;
+        cini->arena.list.front = part->arena.list.front;
+        if (cini->arena.list.back == NULL) {
+            cini->arena.list.back = part->arena.list.back;
+        }
+    }
+    while (error_node != NULL) {
+        CINI_IN_LIST_NODE* next = error_node->next;
+        cini_in_list_append(&cini->error_list, error_node);
+        error_node = next;
+    }
+    while (section_node != NULL) {
+        CINI_IN_LIST_NODE* next_section = section_node->next;
+        CINI_IN_SECTION* section = (CINI_IN_SECTION*)section_node;
+        CINI_IN_LIST_NODE* entry_node = section->entry_list.front;
+        uint32_t section_hash = cini_in_hash_section(&section->name);
+        CINI_IN_SECTION* target = cini_in_find_section(cini, &section->name, section_hash);
+        if (target == NULL) {
+            // The entries are unique in the new section
+            cini_in_list_append(&cini->section_list, section_node);
+            cini_in_index_add(cini, &cini->section_index, section_hash, section_node);
+            for (; entry_node != NULL; entry_node = entry_node->next) {
+                CINI_IN_ENTRY* entry = (CINI_IN_ENTRY*)entry_node;
+                cini_in_index_add(cini, &cini->entry_index, cini_in_hash_entry(section_hash, &entry->name), entry_node);
+            }
+        } else {
+            while (entry_node != NULL) {
+                CINI_IN_LIST_NODE* next_entry = entry_node->next;
+                CINI_IN_ENTRY* entry = (CINI_IN_ENTRY*)entry_node;
+                uint32_t entry_hash = cini_in_hash_entry(section_hash, &entry->name);
+                if (cini_in_find_entry(cini, target, &entry->name, entry_hash) == NULL) {
+                    entry->section = target;
+                    cini_in_list_append(&target->entry_list, entry_node);
+                    cini_in_index_add(cini, &cini->entry_index, entry_hash, entry_node);
+                }
+                entry_node = next_entry;
+            }
+        }
+        section_node = next_section;
+    }
+}
+
+HCINI cini_in_create_handle_parallel(const char* path, int threads)
+{
+    // Split the mapping at the section lines, parse the chunks in parallel and merge them in the file order
+    CINI_IN_HANDLE* cini = cini_in_new_handle(NULL);
+    uint64_t start = cini_in_now_ns();
+    if (cini != NULL) {
+        cini_in_set_source(cini, path);
+        if (cini_in_map_file(&cini->mapping, path)) {
+            const char* data = cini->mapping.data;
+            cini->stats.io_ns = cini_in_now_ns() - start;
+            const char* end = data + cini->mapping.size;
+            size_t size = cini->mapping.size;
+            size_t max_count = size / CINI_PARALLEL_CHUNK_SIZE + 1;
+            int count = (0 < threads) ? threads : cini_in_processor_count();
+            count = (max_count < (size_t)count) ? (int)max_count : count;
+            CINI_IN_CHUNK* chunks = (CINI_IN_CHUNK*)CINI_MALLOC(sizeof(CINI_IN_CHUNK) * count);
+            CINI_IN_CHUNK whole = { data, end, 0, cini };
+            int chunk_count = 0;
+            cini->zero_copy = 1;
+            if (chunks != NULL) {
+                const char* begin = data;
+                for (int i = 1; i < count; ++i) {
+                    const char* target = data + size / count * i;
+                    const char* line_end = NULL;
+                    CINI_IN_STRING section_name;
+                    if (target < begin) {
+                        target = begin;
+                    }
+                    line_end = (const char*)memchr(target, '\n', end - target);
+                    // The chunk must start at the valid section line, the keys after the invalid one belong to the previous section
+                    const char* split = (line_end != NULL) ? cini_in_find_section_header(line_end + 1, end, &section_name) : NULL;
+                    if (split == NULL) {
+                        break;
+                    }
+                    chunks[chunk_count].begin = begin;
+                    chunks[chunk_count].end = split;
+                    chunks[chunk_count].line_no = 0;
+                    chunks[chunk_count].cini = NULL;
+                    ++chunk_count;
+                    begin = split;
+                }
+                chunks[chunk_count].begin = begin;
+                chunks[chunk_count].end = end;
+                chunks[chunk_count].line_no = 0;
+                chunks[chunk_count].cini = NULL;
+                ++chunk_count;
+                chunks[0].cini = cini;
+            } else {
+                // Parse the whole on the calling thread
+                chunks = &whole;
+                chunk_count = 1;
+            }
+            if (1 < chunk_count) {
+                CINI_IN_JOBS count_jobs = { cini_in_count_chunk_job, chunks, chunk_count, 0 };
+                int line_no = 0;
+                cini_in_run_parallel(&count_jobs, chunk_count);
+                for (int i = 0; i < chunk_count; ++i) {
+                    int lines = chunks[i].line_no;
+                    chunks[i].line_no = line_no;
+                    line_no += lines;
+                }
+            }
+            {
+                CINI_IN_JOBS parse_jobs = { cini_in_parse_chunk_job, chunks, chunk_count, 0 };
+                size_t entry_count = 0;
+                cini_in_run_parallel(&parse_jobs, chunk_count);
+                for (int i = 0; i < chunk_count; ++i) {
+                    entry_count += (chunks[i].cini != NULL) ? chunks[i].cini->entry_index.count : 0;
+                }
+                if (1 < chunk_count) {
+                    cini_in_index_reserve(cini, &cini->entry_index, entry_count);
+                }
+                for (int i = 1; i < chunk_count; ++i) {
+                    if (chunks[i].cini != NULL) {
+                        cini_in_merge_handle(cini, chunks[i].cini);
+                    } else {
+                        cini_in_error(cini, "Failed to allocate memory");
+                    }
+                }
+            }
+            if (chunks != &whole) {
+                CINI_FREE(chunks);
+            }
+            // The chunks are parsed at the same time, so the parse time is the wall time of the whole
+            cini->stats.tokenize_ns = cini_in_now_ns() - start - cini->stats.io_ns;
+        } else {
+            cini_in_error(cini, "Cannot open file");
+        }
+    }
+    return (HCINI)cini;
+}
+
+int cini_in_parse_events(const char* path, const char* data, size_t len, const CINI_EVENTS* events, void* user_data)
+{
+    // The same tokenizer as the handle, but the parser has no handle and the file is mapped instead of read into the buffer
+    CINI_IN_PARSER parser;
+    CINI_IN_MAPPING mapping = { NULL, 0 };
+    if (events == NULL) {
+        return 0;
+    }
+    memset(&parser, 0, sizeof(CINI_IN_PARSER));
+    parser.events = events;
+    parser.user_data = user_data;
+    if (path == NULL) {
+        cini_in_parse_memory(&parser, (data != NULL) ? data : "", (data != NULL) ? len : 0);
+    } else if (cini_in_map_file(&mapping, path)) {
+        cini_in_parse_memory(&parser, mapping.data, mapping.size);
+        cini_in_unmap_file(&mapping);
+    } else {
+        cini_in_parse_error(&parser, "Cannot open file");
+        return 0;
+    }
+    return !parser.stopped;
+}
+
+HCINI cini_in_create_handle_compiled(const char* path)
+{
+    CINI_IN_HANDLE* cini = cini_in_new_handle(NULL);
+    if (cini != NULL) {
+        if (!cini_in_map_file(&cini->mapping, path)) {
+            cini_in_error(cini, "Cannot open file");
+        } else if (!cini_in_load_image(&cini->image, cini->mapping.data, cini->mapping.size)) {
+            cini_in_error(cini, "Invalid compiled file");
+        } else if (!cini_in_image_check_source(&cini->image)) {
+            memset(&cini->image, 0, sizeof(cini->image));
+            cini_in_error(cini, "Compiled file is out of date");
+        }
+        if (cini->image.base == NULL) {
+            // The handle works as an empty one
+            cini_in_unmap_file(&cini->mapping);
+        }
+    }
+    return (HCINI)cini;
+}
+
+int cini_in_save_handle(HCINI hcini, const char* path)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    int saved = 0;
+    uint64_t source_hash = 0;
+    if (cini == NULL || path == NULL || cini->filtered) {
+        // The compiled file must have the all of sections
+    } else if (cini->image_buffer != NULL) {
+        // The compacted image has no source hash, it is set in the copy to write
+        size_t size = cini->image.header->size;
+        char* image = cini_in_hash_source(cini, &source_hash) ? (char*)cini_in_arena_malloc(&cini->arena, size) : NULL;
+        if (image != NULL) {
+            memcpy(image, cini->image.base, size);
+            ((CINI_IN_IMAGE_HEADER*)image)->source_hash = source_hash;
+            saved = cini_in_write_file(path, image, size);
+            cini_in_arena_free(&cini->arena, image);
+        }
+    } else if (cini->image.base != NULL) {
+        saved = cini_in_write_file(path, cini->image.base, cini->image.header->size);
+    } else if (cini_in_hash_source(cini, &source_hash)) {
+        size_t size = 0;
+        char* image = cini_in_build_image(cini, source_hash, &size);
+        if (image != NULL) {
+            saved = cini_in_write_file(path, image, size);
+            cini_in_arena_free(&cini->arena, image);
+        }
+    }
+    return saved;
+}
+
+void cini_in_free_handle(HCINI hcini)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini != NULL) {
+        CINI_IN_ARENA arena = cini->arena;
+        cini_in_unmap_file(&cini->mapping);
+        cini_in_arena_free(&arena, cini->image_buffer);
+#if !defined(_WIN32)
+        pthread_mutex_destroy(&cini->lock);
+#endif
+        CINI_IN_LIST_NODE* node = arena.list.front;
+        while (node != NULL) {
+            CINI_IN_LIST_NODE* next = node->next;
+            cini_in_free_memory(&arena, (CINI_IN_MEMORY*)node);
+            node = next;
+        }
+    }
+}
+
+void cini_in_preload_handle(HCINI hcini)
+{
+    // Make the all of lazy values, the compiled file has nothing to make
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || cini->image.base != NULL) {
+        return;
+    }
+    for (CINI_IN_LIST_NODE* section_node = cini->section_list.front; section_node != NULL; section_node = section_node->next) {
+        for (CINI_IN_LIST_NODE* entry_node = cini_in_parse_section(cini, (CINI_IN_SECTION*)section_node)->entry_list.front; entry_node != NULL; entry_node = entry_node->next) {
+            CINI_IN_ENTRY* entry = cini_in_entry_array(cini, (CINI_IN_ENTRY*)entry_node);
+            cini_in_value_numeric(cini, &entry->value);
+            cini_in_value_string(cini, &entry->value);
+            for (int i = 0; i < entry->array_count; ++i) {
+                cini_in_value_numeric(cini, &entry->array[i]);
+                cini_in_value_string(cini, &entry->array[i]);
+            }
+        }
+    }
+}
+
+int cini_in_compact_handle(HCINI hcini)
+{
+    // The handle is the first allocation of its block, the block is kept and the others are released
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    CINI_IN_LIST_NODE* node = NULL;
+    CINI_IN_MEMORY* handle_memory = NULL;
+    size_t size = 0;
+    char* image = NULL;
+    if (cini == NULL || cini->image.base != NULL) {
+        return cini != NULL;
+    }
+    image = cini_in_build_image(cini, 0, &size);
+    if (image == NULL || !cini_in_load_image(&cini->image, image, size)) {
+        memset(&cini->image, 0, sizeof(cini->image));
+        cini_in_arena_free(&cini->arena, image);
+        return 0;
+    }
+    cini->image_buffer = image;
+    node = cini->arena.list.front;
+    while (node != NULL) {
+        CINI_IN_LIST_NODE* next = node->next;
+        CINI_IN_MEMORY* memory = (CINI_IN_MEMORY*)node;
+        if ((char*)(memory + 1) == (char*)cini) {
+            handle_memory = memory;
+        } else {
+            cini_in_free_memory(&cini->arena, memory);
+        }
+        node = next;
+    }
+    assert(handle_memory != NULL);
+    handle_memory->node.next = NULL;
+    handle_memory->ptr = (char*)cini + cini_in_align(sizeof(CINI_IN_HANDLE));
+    cini->arena.list.front = &handle_memory->node;
+    cini->arena.list.back = &handle_memory->node;
+    memset(&cini->error_list, 0, sizeof(cini->error_list));
+    memset(&cini->section_list, 0, sizeof(cini->section_list));
+    memset(&cini->section_index, 0, sizeof(cini->section_index));
+    memset(&cini->entry_index, 0, sizeof(cini->entry_index));
+    memset(&cini->range_list, 0, sizeof(cini->range_list));
+    cini->counted_range = NULL;
+    cini->lazy = 0;
+    memset(&cini->string_index, 0, sizeof(cini->string_index));
+    // The strings were copied into the image
+    cini_in_unmap_file(&cini->mapping);
+    cini->zero_copy = 0;
+    cini->source_path = (cini->source_path != NULL) ? cini_in_image_string(&cini->image, cini->image.header->source_path, 0) : NULL;
+    return 1;
+}
+
+#if CINI_IN_STATS_LOOKUP
+static size_t cini_in_index_probes(const CINI_IN_INDEX* index, uint32_t hash, const CINI_IN_LIST_NODE* node)
+{
+    // The number of slots visited by cini_in_index_find until it found 'node' or reached the empty slot
+    size_t probes = 0;
+    if (index->slots != NULL) {
+        size_t mask = ((size_t)1 << index->bits) - 1;
+        for (size_t i = cini_in_index_home(index->bits, hash); ; i = (i + 1) & mask) {
+            ++probes;
+            if (index->slots[i].node == NULL || index->slots[i].node == node) {
+                break;
+            }
+        }
+    }
+    return probes;
+}
+
+static size_t cini_in_image_probes(const CINI_IN_IMAGE_SLOT* slots, uint32_t bits, uint32_t hash, uint32_t index)
+{
+    // Same as cini_in_index_probes for cini_in_image_find, 'index' is the record index + 1 or 0 if not found
+    size_t mask = ((size_t)1 << bits) - 1;
+    size_t probes = 0;
+    for (size_t i = cini_in_index_home((int)bits, hash); probes <= mask; i = (i + 1) & mask) {
+        ++probes;
+        if (slots[i].index == 0 || slots[i].index == index) {
+            break;
+        }
+    }
+    return probes;
+}
+
+static void cini_in_count_lookup(CINI_IN_HANDLE* cini, const CINI_KEY_DESC* desc, const void* entry)
+{
+    // Probe again to count the slots, it keeps the lookup path free from the counters when CINI_STATS_LOOKUP is not defined
+    CINI_IN_STRING section_name_str = { desc->section, desc->section + desc->section_len };
+    size_t probes = 0;
+    if (cini->image.base != NULL) {
+        const CINI_IN_IMAGE* image = &cini->image;
+        const CINI_IN_IMAGE_HEADER* header = image->header;
+        uint32_t section = cini_in_image_find(image, image->section_slots, header->section_index_bits, desc->section_hash, cini_in_image_match_section, &section_name_str);
+        probes = cini_in_image_probes(image->section_slots, header->section_index_bits, desc->section_hash, section);
+        if (section != 0) {
+            uint32_t index = (entry != NULL) ? (uint32_t)((const CINI_IN_IMAGE_ENTRY*)entry - image->entries) + 1 : 0;
+            probes += cini_in_image_probes(image->entry_slots, header->entry_index_bits, desc->entry_hash, index);
+        }
+    } else {
+        const CINI_IN_SECTION* section = cini_in_find_section(cini, &section_name_str, desc->section_hash);
+        probes = cini_in_index_probes(&cini->section_index, desc->section_hash, (section != NULL) ? &section->node : NULL);
+        if (section != NULL) {
+            probes += cini_in_index_probes(cini->lazy ? &section->entry_index : &cini->entry_index, desc->entry_hash, (const CINI_IN_LIST_NODE*)entry);
+        }
+    }
+    CINI_IN_FETCH_ADD_INT64(&cini->stats.lookup_count, 1);
+    CINI_IN_FETCH_ADD_INT64(&cini->stats.lookup_hit_count, (entry != NULL) ? 1 : 0);
+    CINI_IN_FETCH_ADD_INT64(&cini->stats.probe_count, probes);
+}
+#endif
+
+static const void* cini_in_lookup_desc(CINI_IN_HANDLE* cini, const CINI_KEY_DESC* desc)
+{
+    // The entry is CINI_IN_IMAGE_ENTRY if the handle was loaded from the compiled file, otherwise CINI_IN_ENTRY
+    const void* entry = NULL;
+    if (cini == NULL || desc == NULL) {
+        return NULL;
+    }
+    entry = (cini->image.base != NULL) ? (const void*)cini_in_image_get_entry(&cini->image, desc) : (const void*)cini_in_get_entry(cini, desc);
+#if CINI_IN_STATS_LOOKUP
+    cini_in_count_lookup(cini, desc, entry);
+#endif
+    return entry;
+}
+
+static const void* cini_in_lookup(CINI_IN_HANDLE* cini, const char* section_name, const char* key_name)
+{
+    CINI_KEY_DESC desc = cini_in_make_desc(section_name, key_name);
+    return cini_in_lookup_desc(cini, &desc);
+}
+
+static int cini_in_get_count(CINI_IN_HANDLE* cini, const void* entry)
+{
+    if (entry == NULL) {
+        return 0;
+    }
+    return (cini->image.base != NULL) ? cini_in_image_count(&cini->image, (const CINI_IN_IMAGE_ENTRY*)entry) : cini_in_entry_array(cini, (CINI_IN_ENTRY*)entry)->array_count;
+}
+
+static int cini_in_get_numeric(CINI_IN_HANDLE* cini, const void* entry, int index_, CINI_IN_NUMBER* number)
+{
+    number->f = NAN;
+    number->i = 0;
+    number->flags = 0;
+    if (entry == NULL) {
+        // Not found
+    } else if (cini->image.base != NULL) {
+        const CINI_IN_IMAGE_VALUE* value = cini_in_image_value(&cini->image, (const CINI_IN_IMAGE_ENTRY*)entry, index_);
+        if (value) {
+            number->f = value->f;
+            number->i = value->i;
+            number->flags = (int)value->number_flags;
+        }
+    } else {
+        CINI_IN_VALUE* value = cini_in_entry_value(cini, (CINI_IN_ENTRY*)entry, index_);
+        if (value) {
+            *number = *cini_in_value_numeric(cini, value);
+        }
+    }
+    return !isnan(number->f);
+}
+
+static const char* cini_in_get_string(CINI_IN_HANDLE* cini, const void* entry, int index_)
+{
+    const char* s = NULL;
+    if (entry == NULL) {
+        // Not found
+    } else if (cini->image.base != NULL) {
+        const CINI_IN_IMAGE_VALUE* value = cini_in_image_value(&cini->image, (const CINI_IN_IMAGE_ENTRY*)entry, index_);
+        s = (value) ? cini_in_image_string(&cini->image, value->s, 0) : NULL;
+    } else {
+        CINI_IN_VALUE* value = cini_in_entry_value(cini, (CINI_IN_ENTRY*)entry, index_);
+        s = (value) ? cini_in_value_string(cini, value) : NULL;
+    }
+    return s;
+}
+
+static int cini_in_range_count(int count, int max)
+{
+    return (max <= 0) ? 0 : (count < max) ? count : max;
+}
+
+int cini_in_check_int(double f, int idefault)
+{
+    return (INT32_MIN <= f && f <= INT32_MAX) ? (int)f : idefault;
+}
+
+static float cini_in_check_float(double f, float fdefault)
+{
+    return (-FLT_MAX <= f && f <= FLT_MAX) ? (float)f : fdefault;
+}
+
+static int64_t cini_in_get_int64(CINI_IN_HANDLE* cini, const void* entry, int index_, int64_t idefault)
+{
+    // The exact integer is used if the value was written as integer, otherwise the double is truncated
+    CINI_IN_NUMBER number;
+    if (!cini_in_get_numeric(cini, entry, index_, &number)) {
+        return idefault;
+    }
+    if (number.flags & CINI_IN_NUMBER_INTEGER) {
+        return (number.flags & CINI_IN_NUMBER_UNSIGNED) ? idefault : (int64_t)number.i;
+    }
+    return (-9223372036854775808.0 <= number.f && number.f < 9223372036854775808.0) ? (int64_t)number.f : idefault;
+}
+
+static uint64_t cini_in_get_uint64(CINI_IN_HANDLE* cini, const void* entry, int index_, uint64_t udefault)
+{
+    CINI_IN_NUMBER number;
+    if (!cini_in_get_numeric(cini, entry, index_, &number)) {
+        return udefault;
+    }
+    if (number.flags & CINI_IN_NUMBER_INTEGER) {
+        return ((number.flags & CINI_IN_NUMBER_UNSIGNED) || number.i <= (uint64_t)INT64_MAX) ? number.i : udefault;
+    }
+    return (0.0 <= number.f && number.f < 18446744073709551616.0) ? (uint64_t)number.f : udefault;
+}
+
+static double cini_in_get_double(CINI_IN_HANDLE* cini, const void* entry, int index_, double ddefault)
+{
+    CINI_IN_NUMBER number;
+    return cini_in_get_numeric(cini, entry, index_, &number) ? number.f : ddefault;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HCINI cini_create(const char* path)
+{
+    return cini_in_create_handle(path, NULL, 0, NULL);
+}
+
+HCINI cini_create_with_section(const char* path, const char* section)
+{
+    return cini_in_create_handle(path, (section != NULL) ? &section : NULL, (section != NULL) ? 1 : 0, NULL);
+}
+
+HCINI cini_create_with_sections(const char* path, const char* const* sections, int count)
+{
+    return cini_in_create_handle(path, sections, count, NULL);
+}
+
+HCINI cini_create_ex(const char* path, const char* const* sections, int count, const CINI_ALLOCATOR* allocator)
+{
+    return cini_in_create_handle(path, sections, count, allocator);
+}
+
+int cini_create_many(const char* const* paths, int count, HCINI* out_handles, int threads)
+{
+    return cini_in_create_handles(paths, count, out_handles, threads);
+}
+
+HCINI cini_create_parallel(const char* path, int threads)
+{
+    return cini_in_create_handle_parallel(path, threads);
+}
+
+HCINI cini_create_mmap(const char* path, const char* section)
+{
+    return cini_in_create_handle_mmap(path, (section != NULL) ? &section : NULL, (section != NULL) ? 1 : 0);
+}
+
+HCINI cini_create_lazy(const char* path)
+{
+    return cini_in_create_handle_lazy(path);
+}
+
+HCINI cini_create_from_buffer(const char* data, size_t len, const char* section)
+{
+    return cini_in_create_handle_buffer(data, len, (section != NULL) ? &section : NULL, (section != NULL) ? 1 : 0);
+}
+
+HCINI cini_create_compiled(const char* path)
+{
+    return cini_in_create_handle_compiled(path);
+}
+
+int cini_save_compiled(HCINI hcini, const char* path)
+{
+    return cini_in_save_handle(hcini, path);
+}
+
+int cini_parse_events(const char* path, const CINI_EVENTS* events, void* user_data)
+{
+    return (path != NULL) ? cini_in_parse_events(path, NULL, 0, events, user_data) : 0;
+}
+
+int cini_parse_events_buffer(const char* data, size_t len, const CINI_EVENTS* events, void* user_data)
+{
+    return cini_in_parse_events(NULL, data, len, events, user_data);
+}
+
+void cini_free(HCINI hcini)
+{
+    cini_in_free_handle(hcini);
+}
+
+void cini_preload(HCINI hcini)
+{
+    cini_in_preload_handle(hcini);
+}
+
+int cini_compact(HCINI hcini)
+{
+    return cini_in_compact_handle(hcini);
+}
+
+const char* cini_intern(HCINI hcini, const char* str)
+{
+    const CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    const CINI_IN_INTERNED* interned = NULL;
+    if (cini != NULL && str != NULL && cini->string_index.slots != NULL) {
+        CINI_IN_STRING s = { str, str + strlen(str) };
+        interned = cini_in_find_interned(cini, &s);
+    }
+    return (interned != NULL) ? (const char*)(interned + 1) : NULL;
+}
+
+int cini_getstats(HCINI hcini, CINI_STATS* stats)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || stats == NULL) {
+        return 0;
+    }
+    // The lazy values may be made by the other threads meanwhile
+    memset(stats, 0, sizeof(CINI_STATS));
+    cini_in_lock(&cini->lock);
+    stats->memory_bytes = cini->arena.allocated + ((cini->image_buffer != NULL) ? cini->image.header->size : 0);
+    stats->interned_count = cini->string_index.count;
+    stats->shared_count = cini->shared_count;
+    stats->saved_bytes = cini->saved_bytes;
+    stats->bytes_read = cini->stats.bytes_read;
+    stats->line_count = cini->stats.line_count;
+    stats->section_count = cini->stats.section_count;
+    stats->entry_count = cini->stats.entry_count;
+    stats->value_count = cini->stats.value_count;
+    stats->chunk_count = cini->arena.chunk_count;
+    stats->wasted_bytes = cini->arena.wasted_bytes;
+    stats->index_bytes = cini_in_index_bytes(&cini->section_index) + cini_in_index_bytes(&cini->entry_index) + cini_in_index_bytes(&cini->string_index);
+    for (CINI_IN_LIST_NODE* node = cini->lazy ? cini->section_list.front : NULL; node != NULL; node = node->next) {
+        stats->index_bytes += cini_in_index_bytes(&((CINI_IN_SECTION*)node)->entry_index);
+    }
+    stats->released_bytes = cini->arena.released_bytes;
+    stats->io_ns = cini->stats.io_ns;
+    stats->tokenize_ns = cini->stats.tokenize_ns;
+    stats->number_ns = cini->stats.number_ns;
+    stats->number_count = cini->stats.number_count;
+    cini_in_unlock(&cini->lock);
+    stats->lookup_count = CINI_IN_LOAD_INT64(&cini->stats.lookup_count);
+    stats->lookup_hit_count = CINI_IN_LOAD_INT64(&cini->stats.lookup_hit_count);
+    stats->probe_count = CINI_IN_LOAD_INT64(&cini->stats.probe_count);
+    return 1;
+}
+
+int cini_ismodified(HCINI hcini)
+{
+    const CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return (cini != NULL) ? cini_in_source_modified(cini) : 0;
+}
+
+int cini_geti(HCINI hcini, const char* section, const char* key, int idefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    CINI_IN_NUMBER number;
+    return cini_in_get_numeric(cini, cini_in_lookup(cini, section, key), CINI_IN_WHOLE_VALUE, &number) ? cini_in_check_int(number.f, idefault) : idefault;
+}
+
+float cini_getf(HCINI hcini, const char* section, const char* key, float fdefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    CINI_IN_NUMBER number;
+    return cini_in_get_numeric(cini, cini_in_lookup(cini, section, key), CINI_IN_WHOLE_VALUE, &number) ? cini_in_check_float(number.f, fdefault) : fdefault;
+}
+
+const char* cini_gets(HCINI hcini, const char* section, const char* key, const char* sdefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    const char* s = cini_in_get_string(cini, cini_in_lookup(cini, section, key), CINI_IN_WHOLE_VALUE);
+    return (s) ? s : sdefault;
+}
+
+int cini_getai(HCINI hcini, const char* section, const char* key, int index_, int idefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    CINI_IN_NUMBER number;
+    return (0 <= index_ && cini_in_get_numeric(cini, cini_in_lookup(cini, section, key), index_, &number)) ? cini_in_check_int(number.f, idefault) : idefault;
+}
+float cini_getaf(HCINI hcini, const char* section, const char* key, int index_, float fdefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    CINI_IN_NUMBER number;
+    return (0 <= index_ && cini_in_get_numeric(cini, cini_in_lookup(cini, section, key), index_, &number)) ? cini_in_check_float(number.f, fdefault) : fdefault;
+}
+const char* cini_getas(HCINI hcini, const char* section, const char* key, int index_, const char* sdefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    const char* s = (0 <= index_) ? cini_in_get_string(cini, cini_in_lookup(cini, section, key), index_) : NULL;
+    return (s) ? s : sdefault;
+}
+
+int64_t cini_geti64(HCINI hcini, const char* section, const char* key, int64_t idefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return cini_in_get_int64(cini, cini_in_lookup(cini, section, key), CINI_IN_WHOLE_VALUE, idefault);
+}
+
+uint64_t cini_getu64(HCINI hcini, const char* section, const char* key, uint64_t udefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return cini_in_get_uint64(cini, cini_in_lookup(cini, section, key), CINI_IN_WHOLE_VALUE, udefault);
+}
+
+double cini_getd(HCINI hcini, const char* section, const char* key, double ddefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return cini_in_get_double(cini, cini_in_lookup(cini, section, key), CINI_IN_WHOLE_VALUE, ddefault);
+}
+
+int64_t cini_getai64(HCINI hcini, const char* section, const char* key, int index_, int64_t idefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return (0 <= index_) ? cini_in_get_int64(cini, cini_in_lookup(cini, section, key), index_, idefault) : idefault;
+}
+
+uint64_t cini_getau64(HCINI hcini, const char* section, const char* key, int index_, uint64_t udefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return (0 <= index_) ? cini_in_get_uint64(cini, cini_in_lookup(cini, section, key), index_, udefault) : udefault;
+}
+
+double cini_getad(HCINI hcini, const char* section, const char* key, int index_, double ddefault)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return (0 <= index_) ? cini_in_get_double(cini, cini_in_lookup(cini, section, key), index_, ddefault) : ddefault;
+}
+
+int cini_getcount(HCINI hcini, const char* section, const char* key)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    return cini_in_get_count(cini, cini_in_lookup(cini, section, key));
+}
+
+int cini_getai_range(HCINI hcini, const char* section, const char* key, int* out, int max)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    const void* entry = cini_in_lookup(cini, section, key);
+    int count = cini_in_range_count(cini_in_get_count(cini, entry), max);
+    for (int i = 0; i < count; ++i) {
+        CINI_IN_NUMBER number;
+        out[i] = cini_in_get_numeric(cini, entry, i, &number) ? cini_in_check_int(number.f, out[i]) : out[i];
+    }
+    return count;
+}
+
+int cini_getaf_range(HCINI hcini, const char* section, const char* key, float* out, int max)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    const void* entry = cini_in_lookup(cini, section, key);
+    int count = cini_in_range_count(cini_in_get_count(cini, entry), max);
+    for (int i = 0; i < count; ++i) {
+        CINI_IN_NUMBER number;
+        out[i] = cini_in_get_numeric(cini, entry, i, &number) ? cini_in_check_float(number.f, out[i]) : out[i];
+    }
+    return count;
+}
+
+int cini_getas_range(HCINI hcini, const char* section, const char* key, const char** out, int max)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    const void* entry = cini_in_lookup(cini, section, key);
+    int count = cini_in_range_count(cini_in_get_count(cini, entry), max);
+    for (int i = 0; i < count; ++i) {
+        const char* s = cini_in_get_string(cini, entry, i);
+        out[i] = (s) ? s : out[i];
+    }
+    return count;
+}
+
+CINI_KEY cini_lookup(HCINI hcini, const char* section, const char* key)
+{
+    return (CINI_KEY)cini_in_lookup((CINI_IN_HANDLE*)hcini, section, key);
+}
+
+CINI_KEY cini_lookup_desc(HCINI hcini, const CINI_KEY_DESC* desc)
+{
+    return (CINI_KEY)cini_in_lookup_desc((CINI_IN_HANDLE*)hcini, desc);
+}
+
+CINI_SECTION cini_section_first(HCINI hcini)
+{
+    const CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL) {
+        return NULL;
+    } else if (cini->image.base != NULL) {
+        return (0 < cini->image.header->section_count) ? (CINI_SECTION)cini->image.sections : NULL;
+    }
+    return (CINI_SECTION)cini->section_list.front;
+}
+
+CINI_SECTION cini_section_next(HCINI hcini, CINI_SECTION section)
+{
+    const CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || section == NULL) {
+        return NULL;
+    } else if (cini->image.base != NULL) {
+        const CINI_IN_IMAGE_SECTION* next = (const CINI_IN_IMAGE_SECTION*)section + 1;
+        return (next < cini->image.sections + cini->image.header->section_count) ? (CINI_SECTION)next : NULL;
+    }
+    return (CINI_SECTION)((const CINI_IN_SECTION*)section)->node.next;
+}
+
+const char* cini_section_name(HCINI hcini, CINI_SECTION section)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || section == NULL) {
+        return NULL;
+    } else if (cini->image.base != NULL) {
+        const CINI_IN_IMAGE_SECTION* image_section = (const CINI_IN_IMAGE_SECTION*)section;
+        return cini_in_image_string(&cini->image, image_section->name, image_section->name_len);
+    }
+    return cini_in_lazy_string(cini, &((const CINI_IN_SECTION*)section)->name, &((CINI_IN_SECTION*)section)->s);
+}
+
+CINI_KEY cini_entry_first(HCINI hcini, CINI_SECTION section)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || section == NULL) {
+        return NULL;
+    } else if (cini->image.base != NULL) {
+        // The entries of the section are contiguous in the image
+        const CINI_IN_IMAGE_SECTION* image_section = (const CINI_IN_IMAGE_SECTION*)section;
+        int valid = 0 < image_section->entry_count && (uint64_t)image_section->entries + image_section->entry_count <= cini->image.header->entry_count;
+        return valid ? (CINI_KEY)&cini->image.entries[image_section->entries] : NULL;
+    }
+    return (CINI_KEY)cini_in_parse_section(cini, (CINI_IN_SECTION*)section)->entry_list.front;
+}
+
+CINI_KEY cini_entry_next(HCINI hcini, CINI_KEY entry)
 {
     const CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || entry == NULL) {
+        return NULL;
+    } else if (cini->image.base != NULL) {
+        // The next one must be in the same section, and the range is checked in case the file is broken
+        const CINI_IN_IMAGE* image = &cini->image;
+        const CINI_IN_IMAGE_ENTRY* image_entry = (const CINI_IN_IMAGE_ENTRY*)entry;
+        uint64_t next = (uint64_t)(image_entry - image->entries) + 1;
+        uint64_t end = 0;
+        if (image_entry->section < image->header->section_count) {
+            const CINI_IN_IMAGE_SECTION* section = &image->sections[image_entry->section];
+            end = (uint64_t)section->entries + section->entry_count;
+        }
+        return (next < end && next < image->header->entry_count) ? (CINI_KEY)&image->entries[next] : NULL;
+    }
+    return (CINI_KEY)((const CINI_IN_ENTRY*)entry)->node.next;
+}
+
+const char* cini_entry_name(HCINI hcini, CINI_KEY entry)
+{
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    if (cini == NULL || entry == NULL) {
+        return NULL;
+    } else if (cini->image.base != NULL) {
+        const CINI_IN_IMAGE_ENTRY* image_entry = (const CINI_IN_IMAGE_ENTRY*)entry;
+        return cini_in_image_string(&cini->image, image_entry->name, image_entry->name_len);
+    }
+    return cini_in_lazy_string(cini, &((const CINI_IN_ENTRY*)entry)->name, &((CINI_IN_ENTRY*)entry)->s);
+}
+
+int cini_key_geti(HCINI hcini, CINI_KEY key, int idefault)
+{
+    CINI_IN_NUMBER number;
+    return cini_in_get_numeric((CINI_IN_HANDLE*)hcini, key, CINI_IN_WHOLE_VALUE, &number) ? cini_in_check_int(number.f, idefault) : idefault;
+}
+
+float cini_key_getf(HCINI hcini, CINI_KEY key, float fdefault)
+{
+    CINI_IN_NUMBER number;
+    return cini_in_get_numeric((CINI_IN_HANDLE*)hcini, key, CINI_IN_WHOLE_VALUE, &number) ? cini_in_check_float(number.f, fdefault) : fdefault;
+}
+
+const char* cini_key_gets(HCINI hcini, CINI_KEY key, const char* sdefault)
+{
+    const char* s = cini_in_get_string((CINI_IN_HANDLE*)hcini, key, CINI_IN_WHOLE_VALUE);
+    return (s) ? s : sdefault;
+}
+
+int cini_key_getai(HCINI hcini, CINI_KEY key, int index_, int idefault)
+{
+    CINI_IN_NUMBER number;
+    return (0 <= index_ && cini_in_get_numeric((CINI_IN_HANDLE*)hcini, key, index_, &number)) ? cini_in_check_int(number.f, idefault) : idefault;
+}
+
+float cini_key_getaf(HCINI hcini, CINI_KEY key, int index_, float fdefault)
+{
+    CINI_IN_NUMBER number;
+    return (0 <= index_ && cini_in_get_numeric((CINI_IN_HANDLE*)hcini, key, index_, &number)) ? cini_in_check_float(number.f, fdefault) : fdefault;
+}
+
+const char* cini_key_getas(HCINI hcini, CINI_KEY key, int index_, const char* sdefault)
+{
+    const char* s = (0 <= index_) ? cini_in_get_string((CINI_IN_HANDLE*)hcini, key, index_) : NULL;
+    return (s) ? s : sdefault;
+}
+
+int cini_key_getcount(HCINI hcini, CINI_KEY key)
+{
+    return cini_in_get_count((CINI_IN_HANDLE*)hcini, key);
+}
+
+int64_t cini_key_geti64(HCINI hcini, CINI_KEY key, int64_t idefault)
+{
+    return cini_in_get_int64((CINI_IN_HANDLE*)hcini, key, CINI_IN_WHOLE_VALUE, idefault);
+}
+
+uint64_t cini_key_getu64(HCINI hcini, CINI_KEY key, uint64_t udefault)
+{
+    return cini_in_get_uint64((CINI_IN_HANDLE*)hcini, key, CINI_IN_WHOLE_VALUE, udefault);
+}
+
+double cini_key_getd(HCINI hcini, CINI_KEY key, double ddefault)
+{
+    return cini_in_get_double((CINI_IN_HANDLE*)hcini, key, CINI_IN_WHOLE_VALUE, ddefault);
+}
+
+int64_t cini_key_getai64(HCINI hcini, CINI_KEY key, int index_, int64_t idefault)
+{
+    return (0 <= index_) ? cini_in_get_int64((CINI_IN_HANDLE*)hcini, key, index_, idefault) : idefault;
+}
+
+uint64_t cini_key_getau64(HCINI hcini, CINI_KEY key, int index_, uint64_t udefault)
+{
+    return (0 <= index_) ? cini_in_get_uint64((CINI_IN_HANDLE*)hcini, key, index_, udefault) : udefault;
+}
+
+double cini_key_getad(HCINI hcini, CINI_KEY key, int index_, double ddefault)
+{
+    return (0 <= index_) ? cini_in_get_double((CINI_IN_HANDLE*)hcini, key, index_, ddefault) : ddefault;
+}
+
+int cini_geterrorcount(HCINI hcini)
+{
+    // The lazy handle records the errors while the other threads parse the sections
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
+    int count = 0;
+    if (cini != NULL) {
+        if (cini->lazy) {
+            cini_in_lock(&cini->lock);
+        }
+        count = cini_in_list_count(&cini->error_list) + ((cini->image.base != NULL) ? (int)cini->image.header->error_count : 0);
+        if (cini->lazy) {
+            cini_in_unlock(&cini->lock);
+        }
+    }
+    return count;
+}
+
+const char* cini_geterror(HCINI hcini, int index_)
+{
+    // The errors in the compiled file come first
+    CINI_IN_HANDLE* cini = (CINI_IN_HANDLE*)hcini;
     const char* message = NULL;
     if (cini != NULL) {
-        const CINI_IN_ERROR* error = (CINI_IN_ERROR*)cini_in_list_at(&cini->error_list, index_);
-        if (error) {
-            message = error->message;
+        if (cini->lazy) {
+            cini_in_lock(&cini->lock);
+        }
+        int image_error_count = (cini->image.base != NULL) ? (int)cini->image.header->error_count : 0;
+        if (0 <= index_ && index_ < image_error_count) {
+            message = cini_in_image_string(&cini->image, cini->image.errors[index_], 0);
+        } else {
+            const CINI_IN_ERROR* error = (CINI_IN_ERROR*)cini_in_list_at(&cini->error_list, index_ - image_error_count);
+            if (error) {
+                message = error->message;
+            }
+        }
+        if (cini->lazy) {
+            cini_in_unlock(&cini->lock);
         }
     }
     return message;
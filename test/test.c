@@ -1,14 +1,15 @@
 ﻿#include "test.h"
 #define CINI_IMPLEMENTATION
+// Split the small test files into the chunks for cini_create_parallel
+#define CINI_PARALLEL_CHUNK_SIZE 64
 #include "cini.h"
 
 int main(int argc, char* argv[])
 {
     (void)argc;
     (void)argv;
-    const char* path = "test.ini";
-    test_c(path);
-    // test_cpp(path);
+    test_c("test.ini");
+    test_cpp("test_cpp.ini");
     print_test_summary();
 
     return get_test_result();
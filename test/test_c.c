@@ -1,8 +1,82 @@
 ﻿#include "cini.h"
 #include "test.h"
 
+#include <locale.h>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
+typedef struct {
+    int alloc_count;
+    int live_count;
+    int fail_after;
+} TEST_ALLOCATOR_STATE;
+
+static void* test_alloc(void* user_data, size_t size)
+{
+    TEST_ALLOCATOR_STATE* state = (TEST_ALLOCATOR_STATE*)user_data;
+    if (state->fail_after <= state->alloc_count) {
+        return NULL;
+    }
+    state->alloc_count += 1;
+    state->live_count += 1;
+    return malloc(size);
+}
+
+static void test_free(void* user_data, void* ptr)
+{
+    TEST_ALLOCATOR_STATE* state = (TEST_ALLOCATOR_STATE*)user_data;
+    state->live_count -= 1;
+    free(ptr);
+}
+
+typedef struct {
+    char log[512];
+    size_t len;
+    int count;
+    int stop_after;
+    int key_count;
+    int error_count;
+} TEST_EVENT_STATE;
+
+static int test_event(void* user_data, const char* tag, const char* str, size_t len, int number)
+{
+    TEST_EVENT_STATE* state = (TEST_EVENT_STATE*)user_data;
+    int written = snprintf(state->log + state->len, sizeof(state->log) - state->len, "%s%d:%.*s|", tag, number, (int)len, str);
+    if (0 < written && state->len + written < sizeof(state->log)) {
+        state->len += written;
+    }
+    state->count += 1;
+    return state->count != state->stop_after;
+}
+
+static int test_event_section(void* user_data, const char* name, size_t len, int line_no)
+{
+    return test_event(user_data, "S", name, len, line_no);
+}
+
+static int test_event_key(void* user_data, const char* name, size_t len, int line_no)
+{
+    ((TEST_EVENT_STATE*)user_data)->key_count += 1;
+    return test_event(user_data, "K", name, len, line_no);
+}
+
+static int test_event_value(void* user_data, const char* value, size_t len, int quoted)
+{
+    return test_event(user_data, "V", value, len, quoted);
+}
+
+static int test_event_element(void* user_data, int index_, const char* value, size_t len, int quoted)
+{
+    return test_event(user_data, quoted ? "Q" : "E", value, len, index_);
+}
+
+static int test_event_error(void* user_data, const char* message, int line_no)
+{
+    ((TEST_EVENT_STATE*)user_data)->error_count += 1;
+    return test_event(user_data, "X", message, strlen(message), line_no);
+}
+
 void test_c(const char* path)
 {
     TEST_PRINT(stdout, "\n");
@@ -55,6 +129,9 @@ void test_c(const char* path)
         TEST(cini_getf(hcini, "", "\\key", -999.0f) == -999.0f);
         TEST(strcmp(cini_gets(hcini, "", "\\key", "ERROR"), "KEY") == 0);
 
+        TEST(strcmp(cini_gets(hcini, "", "key", "ERROR"), "ERROR") == 0);
+        TEST(cini_geti(hcini, "int", "key01", -999) == -999);
+
         cini_free(hcini);
     }
     // integer section
@@ -179,6 +256,25 @@ void test_c(const char* path)
         TEST(strcmp(cini_getas(hcini, "array", "key08", 3, "ERROR"), "\"D'") == 0);
         TEST(strcmp(cini_getas(hcini, "array", "key08", 4, "ERROR"), "F") == 0);
 
+        {
+            int iarray[4] = { -999, -999, -999, -999 };
+            TEST(cini_getai_range(hcini, "array", "key01", iarray, 4) == 3);
+            TEST(iarray[0] == 1 && iarray[1] == 2 && iarray[2] == 3 && iarray[3] == -999);
+            TEST(cini_getai_range(hcini, "array", "key01", iarray, 2) == 2);
+            TEST(cini_getai_range(hcini, "array", "key01", iarray, 0) == 0);
+            TEST(cini_getai_range(hcini, "array", "nokey", iarray, 4) == 0);
+        }
+        {
+            float farray[3] = { -999.0f, -999.0f, -999.0f };
+            TEST(cini_getaf_range(hcini, "array", "key05", farray, 3) == 3);
+            TEST(farray[0] == 1.23f && farray[1] == -0.125f && farray[2] == 1234.56006f);
+        }
+        {
+            const char* sarray[5] = { NULL, NULL, NULL, NULL, NULL };
+            TEST(cini_getas_range(hcini, "array", "key06", sarray, 5) == 4);
+            TEST(strcmp(sarray[2], "CCC,DDDD") == 0 && sarray[4] == NULL);
+        }
+
         cini_free(hcini);
     }
     {
@@ -199,6 +295,34 @@ void test_c(const char* path)
         TEST(cini_geti(hcini, "integer", "key01", -999) == 0);
         cini_free(hcini);
     }
+    {
+        const char* sections[] = { "integer", "array" };
+        HCINI hcini = cini_create_with_sections(path, sections, 2);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        TEST(cini_geti(hcini, "integer", "key01", -999) == 0);
+        TEST(cini_geti(hcini, "integer", "intmax", -999) == 2147483647LL);
+        TEST(cini_getf(hcini, "float", "key02", -999.0f) == -999.0f);
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(strcmp(cini_geterror(hcini, 0), "Invalid section name (line:86)") == 0);
+        TEST(strcmp(cini_geterror(hcini, 2), "Invalid key name (line:88)") == 0);
+        cini_free(hcini);
+    }
+    {
+        const char* sections[] = { "float" };
+        HCINI hcini = cini_create_with_sections(path, sections, 1);
+        TEST(cini_getf(hcini, "float", "key02", -999.0f) == 0.5f);
+        TEST(cini_getf(hcini, "float", "floatmax", -999.0f) == 3.40282002e+38f);
+        TEST(cini_geti(hcini, "integer", "key01", -999) == -999);
+        TEST(cini_geterrorcount(hcini) == 2);
+        cini_free(hcini);
+    }
+    {
+        HCINI hcini = cini_create_with_sections(path, NULL, 0);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(cini_geti(hcini, "integer", "key01", -999) == 0);
+        cini_free(hcini);
+    }
     {
         HCINI hcini = cini_create(path);
         TEST(hcini != NULL);
@@ -211,6 +335,865 @@ void test_c(const char* path)
         TEST(cini_geterrorcount(hcini) == 1);
         cini_free(hcini);
     }
+    // long line
+    {
+        const char* long_path = "test_long.ini";
+        FILE* file = fopen(long_path, "wb");
+        TEST(file != NULL);
+        if (file != NULL) {
+            fprintf(file, "[long]\nkey01=");
+            for (int i = 0; i < 20000; i++) {
+                fprintf(file, (i == 0) ? "%d" : ",%d", i);
+            }
+            fprintf(file, "\nkey02=TEST");
+            fclose(file);
+        }
+        HCINI hcini = cini_create(long_path);
+        TEST(cini_geterrorcount(hcini) == 0);
+        TEST(cini_getcount(hcini, "long", "key01") == 20000);
+        TEST(cini_getai(hcini, "long", "key01", 0, -999) == 0);
+        TEST(cini_getai(hcini, "long", "key01", 19999, -999) == 19999);
+        TEST(strlen(cini_gets(hcini, "long", "key01", "")) == 108889);
+        TEST(strcmp(cini_gets(hcini, "long", "key02", "ERROR"), "TEST") == 0);
+        cini_free(hcini);
+        remove(long_path);
+    }
+    // buffer
+    {
+        const char data[] = "key01=1234\n[section]\r\nkey02 = TEST\nkey03=1,2,3\n[]";
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_geterrorcount(hcini) == 1);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(strcmp(cini_gets(hcini, "section", "key02", "ERROR"), "TEST") == 0);
+        TEST(cini_getcount(hcini, "section", "key03") == 3);
+        TEST(cini_getai(hcini, "section", "key03", 2, -999) == 3);
+        cini_free(hcini);
+    }
+    {
+        const char data[] = "key01=1234\n[section]\nkey02=5678";
+        HCINI hcini = cini_create_from_buffer(data, 13, "section");
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        TEST(cini_geti(hcini, "section", "key02", -999) == -999);
+        cini_free(hcini);
+    }
+    {
+        HCINI hcini = cini_create_from_buffer(NULL, 0, NULL);
+        TEST(hcini != NULL);
+        TEST(cini_geterrorcount(hcini) == 0);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        cini_free(hcini);
+    }
+    // long line scanned in blocks
+    {
+        const char data[] = "[section]\n"
+                            "a_key_name_longer_than_thirty_two_bytes : 42\n"
+                            "key01 = 'quoted, value of more than thirty-two bytes' , \"x,y\" z , \"open, end\n";
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_geti(hcini, "section", "a_key_name_longer_than_thirty_two_bytes", -999) == 42);
+        TEST(cini_getcount(hcini, "section", "key01") == 5);
+        TEST(strcmp(cini_getas(hcini, "section", "key01", 0, "ERROR"), "quoted, value of more than thirty-two bytes") == 0);
+        TEST(strcmp(cini_getas(hcini, "section", "key01", 1, "ERROR"), "\"x") == 0);
+        TEST(strcmp(cini_getas(hcini, "section", "key01", 2, "ERROR"), "y\" z") == 0);
+        cini_free(hcini);
+    }
+    // number
+    {
+        const char data[] = "[number]\n"
+                            "exact = 0.1, 1e22, 12e30, 123456789012345678901234567890, 1e-30, 7.\n"
+                            "invalid = 1e, 1.2.3, 0x, #G, 1e99, 0x1234567890ABCDEF0\n"
+                            "hex = 0x7FFFFFFF, #ff\n"
+                            "point = 1,5\n";
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_getaf(hcini, "number", "exact", 0, -999.0f) == 0.1f);
+        TEST(cini_getaf(hcini, "number", "exact", 1, -999.0f) == 1e22f);
+        TEST(cini_getaf(hcini, "number", "exact", 2, -999.0f) == 12e30f);
+        TEST(cini_getaf(hcini, "number", "exact", 3, -999.0f) == 123456789012345678901234567890.0f);
+        TEST(cini_getaf(hcini, "number", "exact", 4, -999.0f) == (float)1e-30);
+        TEST(cini_getai(hcini, "number", "exact", 5, -999) == 7);
+        for (int i = 0; i < cini_getcount(hcini, "number", "invalid"); ++i) {
+            TEST(cini_getai(hcini, "number", "invalid", i, -999) == -999);
+        }
+        TEST(cini_getai(hcini, "number", "hex", 0, -999) == 0x7FFFFFFF);
+        TEST(cini_getai(hcini, "number", "hex", 1, -999) == 255);
+        cini_free(hcini);
+
+        // The decimal point of the locale is not used
+        if (setlocale(LC_NUMERIC, "de_DE.UTF-8") != NULL || setlocale(LC_NUMERIC, "de_DE") != NULL) {
+            hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+            TEST(cini_getaf(hcini, "number", "exact", 0, -999.0f) == 0.1f);
+            TEST(cini_getaf(hcini, "number", "exact", 3, -999.0f) == 123456789012345678901234567890.0f);
+            TEST(cini_getf(hcini, "number", "point", -999.0f) == -999.0f);
+            cini_free(hcini);
+            setlocale(LC_NUMERIC, "C");
+        }
+    }
+    // long mantissa (over 2^53) is rounded as strtod does
+    {
+        static const char* const numbers[] = {
+            "9007199254740993.0", "9007199254740995.0", "9007199254740993.000000001", "0.30000000000000004",
+            "0.10000000000000001", "123456.12345678901", "1.7976931348623157e308", "2.2250738585072014e-308",
+            "1234567890123456789e-27", "1234567890123456789e27", "1234567890123456789e-28",
+            "99999999999999999.5", "0.000000000012345678901234567"
+        };
+        char data[4096] = "[number]\nvalues = ";
+        char* endp = NULL;
+        for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+            strcat(data, (i == 0) ? "" : ",");
+            strcat(data, numbers[i]);
+        }
+        HCINI hcini = cini_create_from_buffer(data, strlen(data), NULL);
+        for (int i = 0; i < (int)(sizeof(numbers) / sizeof(numbers[0])); i++) {
+            TEST(cini_getad(hcini, "number", "values", i, -999.0) == strtod(numbers[i], &endp));
+        }
+        cini_free(hcini);
+
+        // Same as strtod for the shortest representation of the random doubles
+        unsigned int state = 12345;
+        for (int n = 0; n < 100; n++) {
+            char number[32];
+            size_t len = strlen("[number]\nvalues = ");
+            data[len] = '\0';
+            for (int i = 0; i < 32; i++) {
+                state = state * 1103515245u + 12345u;
+                uint64_t bits = ((uint64_t)state << 32) ^ ((uint64_t)(state * 2654435761u) << 7) ^ state;
+                double d = (double)(bits >> 11) * ldexp(1.0, (int)(state % 80) - 80);
+                snprintf(number, sizeof(number), (i % 2) ? "%.17g" : "%.18g", d);
+                strcat(data, (i == 0) ? "" : ",");
+                strcat(data, number);
+            }
+            hcini = cini_create_from_buffer(data, strlen(data), NULL);
+            const char* p = data + len;
+            for (int i = 0; i < 32; i++) {
+                double expected = strtod(p, &endp);
+                TEST(cini_getad(hcini, "number", "values", i, -999.0) == expected);
+                p = endp + 1;
+            }
+            cini_free(hcini);
+        }
+    }
+    // 64-bit number
+    {
+        const char data[] = "[number]\n"
+                            "max = 9223372036854775807\n"
+                            "umax = 18446744073709551615\n"
+                            "min = -9223372036854775808\n"
+                            "hex = 0xFFFFFFFFFFFFFFFF, #7FFFFFFFFFFFFFFF\n"
+                            "over = 18446744073709551616\n"
+                            "large = 1e300\n"
+                            "fraction = -2.5\n"
+                            "array = 1, 9007199254740993, x\n";
+        const char* compiled_path = "test_number.cini";
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_save_compiled(hcini, compiled_path));
+        for (int compiled = 0; compiled < 2; ++compiled) {
+            TEST(cini_geti64(hcini, "number", "max", -999) == INT64_MAX);
+            TEST(cini_getu64(hcini, "number", "max", 999) == (uint64_t)INT64_MAX);
+            TEST(cini_geti(hcini, "number", "max", -999) == -999);
+            TEST(cini_geti64(hcini, "number", "umax", -999) == -999);
+            TEST(cini_getu64(hcini, "number", "umax", 999) == UINT64_MAX);
+            TEST(cini_geti64(hcini, "number", "min", -999) == INT64_MIN);
+            TEST(cini_getu64(hcini, "number", "min", 999) == 999);
+            TEST(cini_getau64(hcini, "number", "hex", 0, 999) == UINT64_MAX);
+            TEST(cini_getai64(hcini, "number", "hex", 1, -999) == INT64_MAX);
+            TEST(cini_getu64(hcini, "number", "over", 999) == 999);
+            TEST(cini_getd(hcini, "number", "over", -999.0) == 18446744073709551616.0);
+            TEST(cini_getd(hcini, "number", "large", -999.0) == 1e300);
+            TEST(cini_getf(hcini, "number", "large", -999.0f) == -999.0f);
+            TEST(cini_geti64(hcini, "number", "large", -999) == -999);
+            TEST(cini_geti64(hcini, "number", "fraction", -999) == -2);
+            TEST(cini_getu64(hcini, "number", "fraction", 999) == 999);
+            TEST(cini_getd(hcini, "number", "fraction", -999.0) == -2.5);
+            TEST(cini_getai64(hcini, "number", "array", 1, -999) == 9007199254740993);
+            TEST(cini_getad(hcini, "number", "array", 2, -999.0) == -999.0);
+            TEST(cini_key_getu64(hcini, cini_lookup(hcini, "number", "umax"), 999) == UINT64_MAX);
+            cini_free(hcini);
+            hcini = cini_create_compiled(compiled_path);
+        }
+        cini_free(hcini);
+        remove(compiled_path);
+    }
+    // allocator
+    {
+        TEST_ALLOCATOR_STATE state = { 0, 0, 1000000 };
+        CINI_ALLOCATOR allocator = { test_alloc, test_free, &state };
+        const char* sections[] = { "integer" };
+        HCINI hcini = cini_create_ex(path, NULL, 0, &allocator);
+        TEST(0 < state.live_count);
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(cini_geti(hcini, "integer", "key02", -999) == 1234);
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(cini_save_compiled(hcini, "test_allocator.cini"));
+        cini_free(hcini);
+        remove("test_allocator.cini");
+        TEST(state.live_count == 0);
+
+        hcini = cini_create_ex(path, sections, 1, &allocator);
+        TEST(cini_geti(hcini, "integer", "key02", -999) == 1234);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        cini_free(hcini);
+        TEST(state.live_count == 0);
+
+        // The allocations fail on the way
+        for (int fail_after = 0; fail_after < 8; fail_after++) {
+            state.alloc_count = 0;
+            state.fail_after = fail_after;
+            hcini = cini_create_ex(path, NULL, 0, &allocator);
+            TEST(cini_geti(hcini, "integer", "key02", -999) == 1234 || cini_geti(hcini, "integer", "key02", -999) == -999);
+            cini_free(hcini);
+            TEST(state.live_count == 0);
+        }
+
+        // The chunks grow with the data
+        const char* large_path = "test_allocator.ini";
+        FILE* file = fopen(large_path, "wb");
+        TEST(file != NULL);
+        if (file != NULL) {
+            fprintf(file, "[large]\n");
+            for (int i = 0; i < 10000; i++) {
+                fprintf(file, "key%d = %d\n", i, i);
+            }
+            fclose(file);
+        }
+        state.alloc_count = 0;
+        state.fail_after = 1000000;
+        hcini = cini_create_ex(large_path, NULL, 0, &allocator);
+        TEST(cini_geti(hcini, "large", "key9999", -999) == 9999);
+        TEST(state.alloc_count < 64);
+        cini_free(hcini);
+        TEST(state.live_count == 0);
+        remove(large_path);
+
+        hcini = cini_create_ex(path, NULL, 0, NULL);
+        TEST(cini_geti(hcini, "integer", "key02", -999) == 1234);
+        cini_free(hcini);
+    }
+    // parallel loading
+    {
+        const char* paths[] = { path, path, "not_found.ini", path, path };
+        HCINI handles[5] = { NULL };
+        TEST(cini_create_many(paths, 5, handles, 3) == 5);
+        for (int i = 0; i < 5; ++i) {
+            if (i == 2) {
+                TEST(cini_geterrorcount(handles[i]) == 1);
+                TEST(strcmp(cini_geterror(handles[i], 0), "Cannot open file (line:0)") == 0);
+            } else {
+                TEST(cini_geterrorcount(handles[i]) == 3);
+                TEST(cini_geti(handles[i], "integer", "key02", -999) == 1234);
+            }
+            cini_free(handles[i]);
+        }
+        TEST(cini_create_many(paths, 1, handles, 0) == 1);
+        TEST(cini_geti(handles[0], "integer", "key02", -999) == 1234);
+        cini_free(handles[0]);
+        TEST(cini_create_many(paths, 0, handles, 0) == 0);
+    }
+    // parallel parsing
+    {
+        // The sections are repeated so that the duplicates are split into the different chunks
+        const char* parallel_path = "test_parallel.ini";
+        FILE* file = fopen(parallel_path, "wb");
+        TEST(file != NULL);
+        if (file != NULL) {
+            fprintf(file, "top=1\n");
+            for (int i = 0; i < 40; i++) {
+                fprintf(file, (i % 2 == 0) ? "[s%d]\n" : "  [s%d]\n", i % 7);
+                for (int k = 0; k < 4; k++) {
+                    fprintf(file, "k%d = %d\n", k, i * 10 + k);
+                }
+                fprintf(file, "dup = %d\ndup = -1\n", i);
+                if (i % 5 == 0) {
+                    fprintf(file, "= %d\n", i);
+                }
+            }
+            fclose(file);
+        }
+        for (int threads = 0; threads <= 8; threads++) {
+            HCINI expected = cini_create_mmap(parallel_path, NULL);
+            HCINI hcini = cini_create_parallel(parallel_path, threads);
+            TEST(cini_geterrorcount(hcini) == 8);
+            TEST(cini_geterrorcount(hcini) == cini_geterrorcount(expected));
+            for (int i = 0; i < cini_geterrorcount(expected); i++) {
+                TEST(strcmp(cini_geterror(hcini, i), cini_geterror(expected, i)) == 0);
+            }
+            TEST(cini_geti(hcini, "", "top", -999) == 1);
+            for (int i = 0; i < 7; i++) {
+                char section[8];
+                snprintf(section, sizeof(section), "s%d", i);
+                TEST(cini_geti(hcini, section, "k0", -999) == i * 10);
+                TEST(cini_geti(hcini, section, "k3", -999) == i * 10 + 3);
+                TEST(cini_geti(hcini, section, "dup", -999) == i);
+            }
+            cini_free(expected);
+            cini_free(hcini);
+        }
+        remove(parallel_path);
+
+        // The invalid section lines do not split the chunks, their keys stay in the previous section
+        file = fopen(parallel_path, "wb");
+        TEST(file != NULL);
+        if (file != NULL) {
+            for (int i = 0; i < 20; i++) {
+                fprintf(file, "[s%d]\nk = %d\n; filler\n[broken%d\nb = %d\n; filler\n", i, i, i, i);
+            }
+            fclose(file);
+        }
+        for (int threads = 2; threads <= 8; threads++) {
+            HCINI expected = cini_create_mmap(parallel_path, NULL);
+            HCINI hcini = cini_create_parallel(parallel_path, threads);
+            TEST(cini_geterrorcount(hcini) == 20);
+            for (int i = 0; i < cini_geterrorcount(expected); i++) {
+                TEST(strcmp(cini_geterror(hcini, i), cini_geterror(expected, i)) == 0);
+            }
+            for (int i = 0; i < 20; i++) {
+                char section[8];
+                snprintf(section, sizeof(section), "s%d", i);
+                TEST(cini_geti(hcini, section, "k", -999) == i);
+                TEST(cini_geti(hcini, section, "b", -999) == i);
+            }
+            TEST(cini_geti(hcini, "", "b", -999) == -999);
+            cini_free(expected);
+            cini_free(hcini);
+        }
+        remove(parallel_path);
+
+        HCINI hcini = cini_create_parallel(path, 4);
+        HCINI expected = cini_create_mmap(path, NULL);
+        TEST(cini_geterrorcount(hcini) == 3);
+        for (int i = 0; i < cini_geterrorcount(expected); i++) {
+            TEST(strcmp(cini_geterror(hcini, i), cini_geterror(expected, i)) == 0);
+        }
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(cini_getf(hcini, "float", "key08", -999.0f) == 0.123456001f);
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(cini_ismodified(hcini) == 0);
+        cini_free(expected);
+        cini_free(hcini);
+
+        hcini = cini_create_parallel("not_found.ini", 0);
+        TEST(cini_geterrorcount(hcini) == 1);
+        TEST(strcmp(cini_geterror(hcini, 0), "Cannot open file (line:0)") == 0);
+        cini_free(hcini);
+    }
+    // interning
+    {
+        const char data[] = "[a]\nhost = example\nport = 80\n[b]\nhost = example\nport = 80\n[a]\nweight = 1\n";
+        CINI_STATS stats;
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(0 < stats.memory_bytes);
+#if defined(CINI_NO_INTERN)
+        TEST(cini_intern(hcini, "host") == NULL);
+#else
+        TEST(stats.interned_count == 6);
+        TEST(stats.shared_count == 2);
+        TEST(stats.saved_bytes == 10);
+        TEST(cini_intern(hcini, "host") != NULL);
+        TEST(strcmp(cini_intern(hcini, "port"), "port") == 0);
+        TEST(cini_intern(hcini, "b") != NULL);
+#endif
+        TEST(cini_intern(hcini, "example") == NULL);
+        TEST(cini_intern(hcini, "missing") == NULL);
+        TEST(cini_intern(hcini, NULL) == NULL);
+        TEST(cini_compact(hcini));
+        TEST(cini_intern(hcini, "host") == NULL);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(0 < stats.memory_bytes);
+        cini_free(hcini);
+
+        hcini = cini_create_mmap(path, NULL);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.interned_count == 0);
+        TEST(cini_intern(hcini, "key01") == NULL);
+        cini_free(hcini);
+
+        hcini = cini_create_lazy(path);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.interned_count == 0);
+        TEST(cini_intern(hcini, "key01") == NULL);
+        cini_free(hcini);
+        TEST(cini_getstats(NULL, &stats) == 0);
+    }
+    // statistics (the test is built with and without CINI_STATS_LOOKUP)
+    {
+        const char data[] = "[a]\nx = 1, 2, 3\ny = 0x10\n[b]\n; comment\nz = s\n";
+        CINI_STATS stats;
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.bytes_read == sizeof(data) - 1);
+        TEST(stats.line_count == 6);
+        TEST(stats.section_count == 3);
+        TEST(stats.entry_count == 3);
+        TEST(stats.value_count == 3);
+        TEST(0 < stats.chunk_count);
+        TEST(stats.number_count == 0);
+        TEST(stats.lookup_count == 0);
+        TEST(cini_getcount(hcini, "a", "x") == 3);
+        TEST(cini_geti(hcini, "a", "y", -999) == 16);
+        TEST(cini_geti(hcini, "a", "y", -999) == 16);
+        TEST(cini_geti(hcini, "c", "x", -999) == -999);
+        TEST(cini_geti(hcini, "b", "x", -999) == -999);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.value_count == 6);
+        TEST(stats.number_count == 1);
+#if defined(CINI_STATS_LOOKUP)
+        TEST(stats.lookup_count == 5);
+        TEST(stats.lookup_hit_count == 3);
+        TEST(9 <= stats.probe_count);
+#else
+        TEST(stats.number_ns == 0);
+        TEST(stats.lookup_count == 0);
+        TEST(stats.lookup_hit_count == 0);
+        TEST(stats.probe_count == 0);
+#endif
+        TEST(cini_compact(hcini));
+        TEST(cini_geti(hcini, "a", "y", -999) == 16);
+        TEST(cini_geti(hcini, "a", "z", -999) == -999);
+        TEST(cini_getstats(hcini, &stats));
+#if defined(CINI_STATS_LOOKUP)
+        TEST(stats.lookup_count == 7);
+        TEST(stats.lookup_hit_count == 4);
+        TEST(13 <= stats.probe_count);
+#else
+        TEST(stats.lookup_count == 0);
+#endif
+        cini_free(hcini);
+
+        // The old slots of the grown indexes are released while parsing
+        static char many[65536] = "[many]\n";
+        for (int i = 0; i < 4000; i++) {
+            snprintf(many + strlen(many), sizeof(many) - strlen(many), "k%d = %d\n", i, i);
+        }
+        hcini = cini_create_from_buffer(many, strlen(many), NULL);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.entry_count == 4000);
+        TEST(0 < stats.index_bytes && stats.index_bytes < stats.memory_bytes);
+        TEST(0 < stats.released_bytes);
+        TEST(cini_geti(hcini, "many", "k0", -999) == 0);
+        TEST(cini_lookup(hcini, "many", "k3999") != NULL);
+        TEST(cini_compact(hcini));
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.index_bytes == 0);
+        cini_free(hcini);
+
+        // Same source in the all of modes
+        CINI_STATS expected;
+        hcini = cini_create(path);
+        TEST(cini_getstats(hcini, &expected));
+        TEST(0 < expected.bytes_read);
+        TEST(0 < expected.line_count);
+        TEST(expected.entry_count == expected.value_count);
+        cini_free(hcini);
+        for (int mode = 0; mode < 2; mode++) {
+            hcini = (mode == 0) ? cini_create_mmap(path, NULL) : cini_create_parallel(path, 4);
+            TEST(cini_getstats(hcini, &stats));
+            TEST(stats.bytes_read == expected.bytes_read);
+            TEST(stats.line_count == expected.line_count);
+            cini_free(hcini);
+        }
+        hcini = cini_create_with_section(path, "array");
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.bytes_read == expected.bytes_read);
+        TEST(stats.line_count == expected.line_count);
+        TEST(stats.section_count == 1);
+        cini_free(hcini);
+    }
+    // iteration
+    for (int compact = 0; compact < 2; compact++) {
+        const char data[] = "a = 1\n[s1]\nx = 1, 2\ny = v\n[s2]\n[s1]\nz = 3\n";
+        HCINI hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        if (compact) {
+            TEST(cini_compact(hcini));
+        }
+        CINI_SECTION section = cini_section_first(hcini);
+        TEST(strcmp(cini_section_name(hcini, section), "") == 0);
+        CINI_KEY entry = cini_entry_first(hcini, section);
+        TEST(strcmp(cini_entry_name(hcini, entry), "a") == 0);
+        TEST(cini_key_geti(hcini, entry, -999) == 1);
+        TEST(cini_entry_next(hcini, entry) == NULL);
+        section = cini_section_next(hcini, section);
+        TEST(strcmp(cini_section_name(hcini, section), "s1") == 0);
+        entry = cini_entry_first(hcini, section);
+        TEST(strcmp(cini_entry_name(hcini, entry), "x") == 0);
+        TEST(cini_key_getcount(hcini, entry) == 2);
+        TEST(cini_key_getai(hcini, entry, 1, -999) == 2);
+        entry = cini_entry_next(hcini, entry);
+        TEST(strcmp(cini_entry_name(hcini, entry), "y") == 0);
+        TEST(strcmp(cini_key_gets(hcini, entry, "ERROR"), "v") == 0);
+        entry = cini_entry_next(hcini, entry);
+        TEST(strcmp(cini_entry_name(hcini, entry), "z") == 0);
+        TEST(cini_entry_next(hcini, entry) == NULL);
+        section = cini_section_next(hcini, section);
+        TEST(strcmp(cini_section_name(hcini, section), "s2") == 0);
+        TEST(cini_entry_first(hcini, section) == NULL);
+        TEST(cini_section_next(hcini, section) == NULL);
+        cini_free(hcini);
+    }
+    for (int mode = 0; mode < 4; mode++) {
+        // The all of entries are found by the names got from the iteration
+        HCINI hcini = (mode == 1) ? cini_create_mmap(path, NULL) : (mode == 2) ? cini_create_parallel(path, 4) : cini_create(path);
+        int entry_count = 0;
+        if (mode == 3) {
+            TEST(cini_compact(hcini));
+        }
+        for (CINI_SECTION section = cini_section_first(hcini); section != NULL; section = cini_section_next(hcini, section)) {
+            const char* section_name = cini_section_name(hcini, section);
+            for (CINI_KEY entry = cini_entry_first(hcini, section); entry != NULL; entry = cini_entry_next(hcini, entry)) {
+                const char* key_name = cini_entry_name(hcini, entry);
+                TEST(cini_lookup(hcini, section_name, key_name) == entry);
+                entry_count++;
+            }
+        }
+        TEST(entry_count == 65);
+        cini_free(hcini);
+    }
+    {
+        HCINI hcini = cini_create_with_section(path, "array");
+        CINI_SECTION section = cini_section_first(hcini);
+        TEST(strcmp(cini_section_name(hcini, section), "array") == 0);
+        TEST(cini_section_next(hcini, section) == NULL);
+        cini_free(hcini);
+        TEST(cini_section_first(NULL) == NULL);
+        TEST(cini_section_next(NULL, NULL) == NULL);
+        TEST(cini_section_name(NULL, NULL) == NULL);
+        TEST(cini_entry_first(NULL, NULL) == NULL);
+        TEST(cini_entry_next(NULL, NULL) == NULL);
+        TEST(cini_entry_name(NULL, NULL) == NULL);
+    }
+    // events
+    {
+        const char data[] = "a = 1\n[s1]\nx = 1, \"2,3\"\n[]\ny\n= v\n[s1]\nx = 'dup'\n";
+        const CINI_EVENTS events = { test_event_section, test_event_key, test_event_value, test_event_element, test_event_error };
+        TEST_EVENT_STATE state;
+        memset(&state, 0, sizeof(state));
+        TEST(cini_parse_events_buffer(data, sizeof(data) - 1, &events, &state));
+        TEST(strcmp(state.log, "K1:a|V0:1|E0:1|S2:s1|K3:x|V0:1, \"2,3\"|E0:1|Q1:2,3|X4:Invalid section name|K5:y|V0:|X6:Invalid key name|S7:s1|K8:x|V1:dup|Q0:dup|") == 0);
+
+        // Stopped by the callback
+        memset(&state, 0, sizeof(state));
+        state.stop_after = 4;
+        TEST(cini_parse_events_buffer(data, sizeof(data) - 1, &events, &state) == 0);
+        TEST(strcmp(state.log, "K1:a|V0:1|E0:1|S2:s1|") == 0);
+
+        // The null callbacks are skipped
+        const CINI_EVENTS key_events = { NULL, test_event_key, NULL, NULL, NULL };
+        memset(&state, 0, sizeof(state));
+        TEST(cini_parse_events_buffer(data, sizeof(data) - 1, &key_events, &state));
+        TEST(strcmp(state.log, "K1:a|K3:x|K5:y|K8:x|") == 0);
+        TEST(cini_parse_events_buffer(NULL, 0, &events, &state));
+        TEST(cini_parse_events_buffer(data, sizeof(data) - 1, NULL, &state) == 0);
+
+        // Same errors as the handle
+        HCINI hcini = cini_create(path);
+        memset(&state, 0, sizeof(state));
+        TEST(cini_parse_events(path, &events, &state));
+        TEST(state.error_count == cini_geterrorcount(hcini));
+        TEST(65 <= state.key_count);
+        cini_free(hcini);
+
+        memset(&state, 0, sizeof(state));
+        TEST(cini_parse_events("not_found.ini", &events, &state) == 0);
+        TEST(strcmp(state.log, "X0:Cannot open file|") == 0);
+        TEST(cini_parse_events(NULL, &events, &state) == 0);
+    }
+    // compaction
+    for (int mmap = 0; mmap < 2; mmap++) {
+        HCINI expected = cini_create(path);
+        HCINI hcini = mmap ? cini_create_mmap(path, NULL) : cini_create(path);
+        TEST(cini_compact(hcini));
+        TEST(cini_compact(hcini));
+        TEST(cini_geterrorcount(hcini) == 3);
+        for (int i = 0; i < cini_geterrorcount(expected); i++) {
+            TEST(strcmp(cini_geterror(hcini, i), cini_geterror(expected, i)) == 0);
+        }
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(strcmp(cini_gets(hcini, "", "k\te\ty", "ERROR"), "T\tE\tS\tT") == 0);
+        TEST(cini_getf(hcini, "float", "key08", -999.0f) == 0.123456001f);
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(strcmp(cini_getas(hcini, "array", "key07", 2, "ERROR"), "C\"C\"C , C ") == 0);
+        TEST(cini_key_geti(hcini, cini_lookup(hcini, "integer", "key02"), -999) == 1234);
+        TEST(cini_ismodified(hcini) == 0);
+        TEST(cini_save_compiled(hcini, "test_compact.cini"));
+        cini_free(hcini);
+        cini_free(expected);
+
+        hcini = cini_create_compiled("test_compact.cini");
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(cini_geti(hcini, "integer", "key02", -999) == 1234);
+        cini_free(hcini);
+        remove("test_compact.cini");
+    }
+    {
+        // The nodes are released and the same strings are shared
+        TEST_ALLOCATOR_STATE state = { 0, 0, 1000000 };
+        CINI_ALLOCATOR allocator = { test_alloc, test_free, &state };
+        const char data[] = "[a]\nhost = example\nport = 80\n[b]\nhost = example\nport = 80\n";
+        HCINI hcini = cini_create_ex(path, NULL, 0, &allocator);
+        TEST(2 < state.live_count);
+        TEST(cini_compact(hcini));
+        TEST(state.live_count == 2);
+        TEST(cini_geti(hcini, "integer", "key02", -999) == 1234);
+        cini_free(hcini);
+        TEST(state.live_count == 0);
+
+        hcini = cini_create_from_buffer(data, sizeof(data) - 1, NULL);
+        TEST(cini_compact(hcini));
+        TEST(cini_gets(hcini, "a", "host", NULL) == cini_gets(hcini, "b", "host", NULL));
+        TEST(cini_geti(hcini, "b", "port", -999) == 80);
+        TEST(cini_ismodified(hcini) == 0);
+        TEST(cini_save_compiled(hcini, "test_compact.cini"));
+        cini_free(hcini);
+        remove("test_compact.cini");
+
+        hcini = cini_create_with_section(path, "integer");
+        TEST(cini_compact(hcini));
+        TEST(cini_geti(hcini, "integer", "key02", -999) == 1234);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        TEST(cini_save_compiled(hcini, "test_compact.cini") == 0);
+        cini_free(hcini);
+        TEST(cini_compact(NULL) == 0);
+    }
+    // memory mapped file
+    {
+        HCINI hcini = cini_create_mmap(path, NULL);
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(strcmp(cini_gets(hcini, "", "key02", "ERROR"), "TEST") == 0);
+        TEST(strcmp(cini_gets(hcini, "", "k\te\ty", "ERROR"), "T\tE\tS\tT") == 0);
+        TEST(cini_geti(hcini, "integer", "intmin", -999) == -2147483648LL);
+        TEST(cini_getf(hcini, "float", "key08", -999.0f) == 0.123456001f);
+        TEST(strcmp(cini_gets(hcini, "string", "key01", "ERROR"), "") == 0);
+        TEST(strcmp(cini_gets(hcini, "string", "key08", "ERROR"), "\"TEST\"") == 0);
+        TEST(cini_gets(hcini, "string", "key08", "ERROR") == cini_gets(hcini, "string", "key08", "ERROR"));
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(strcmp(cini_getas(hcini, "array", "key07", 2, "ERROR"), "C\"C\"C , C ") == 0);
+        TEST(cini_getaf(hcini, "array", "key05", 1, -999.0f) == -0.125f);
+        cini_free(hcini);
+    }
+    {
+        HCINI hcini = cini_create_mmap(path, "integer");
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        TEST(cini_geti(hcini, "integer", "key01", -999) == 0);
+        cini_free(hcini);
+    }
+    {
+        HCINI hcini = cini_create_mmap("alkjgbak4nubiato", NULL);
+        TEST(hcini != NULL);
+        TEST(cini_geterrorcount(hcini) == 1);
+        cini_free(hcini);
+    }
+    // lazy parsing
+    {
+        HCINI expected = cini_create(path);
+        HCINI hcini = cini_create_lazy(path);
+        CINI_STATS expected_stats;
+        CINI_STATS stats;
+        TEST(cini_getstats(expected, &expected_stats));
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.section_count == expected_stats.section_count);
+        TEST(stats.entry_count == 0);
+        TEST(stats.bytes_read < expected_stats.bytes_read);
+        TEST(cini_geterrorcount(hcini) == 0);
+        TEST(cini_geti(hcini, "integer", "intmin", -999) == -2147483648LL);
+        TEST(cini_geterrorcount(hcini) == 0);
+        // The duplicate section is parsed from the both of ranges
+        TEST(cini_getf(hcini, "float", "key08", -999.0f) == cini_getf(expected, "float", "key08", -999.0f));
+        TEST(cini_getf(hcini, "float", "key13", -999.0f) == cini_getf(expected, "float", "key13", -999.0f));
+        TEST(cini_geti(hcini, "string", "none", -999) == -999);
+        TEST(cini_geti(hcini, "none", "key01", -999) == -999);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.bytes_read < expected_stats.bytes_read);
+        // The errors are recorded when their section is parsed, the line numbers are same as the whole parse
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(strcmp(cini_geterror(hcini, 0), "Invalid section name (line:86)") == 0);
+        TEST(strcmp(cini_geterror(hcini, 2), "Invalid key name (line:88)") == 0);
+        cini_preload(hcini);
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(cini_getstats(hcini, &stats));
+        TEST(stats.bytes_read == expected_stats.bytes_read);
+        TEST(stats.line_count == expected_stats.line_count);
+        TEST(stats.entry_count == expected_stats.entry_count);
+        for (CINI_SECTION section = cini_section_first(expected); section != NULL; section = cini_section_next(expected, section)) {
+            const char* section_name = cini_section_name(expected, section);
+            for (CINI_KEY entry = cini_entry_first(expected, section); entry != NULL; entry = cini_entry_next(expected, entry)) {
+                const char* key_name = cini_entry_name(expected, entry);
+                TEST(strcmp(cini_gets(hcini, section_name, key_name, "ERROR"), cini_key_gets(expected, entry, "ERROR")) == 0);
+                TEST(cini_getcount(hcini, section_name, key_name) == cini_key_getcount(expected, entry));
+            }
+        }
+        cini_free(hcini);
+        cini_free(expected);
+    }
+    for (int compact = 0; compact < 2; compact++) {
+        // The sections not accessed yet are parsed by the iteration and by the compaction
+        HCINI hcini = cini_create_lazy(path);
+        int entry_count = 0;
+        if (compact) {
+            TEST(cini_compact(hcini));
+            TEST(cini_geterrorcount(hcini) == 3);
+        }
+        for (CINI_SECTION section = cini_section_first(hcini); section != NULL; section = cini_section_next(hcini, section)) {
+            for (CINI_KEY entry = cini_entry_first(hcini, section); entry != NULL; entry = cini_entry_next(hcini, entry)) {
+                TEST(cini_lookup(hcini, cini_section_name(hcini, section), cini_entry_name(hcini, entry)) == entry);
+                entry_count++;
+            }
+        }
+        TEST(entry_count == 65);
+        TEST(cini_geterrorcount(hcini) == 3);
+        cini_free(hcini);
+    }
+    {
+        const char data[] = "\xEF\xBB\xBF" "a = 1\n  [s1] ; c\nx = 2\n[\n[s2]\r\ny = 3\n[s1]\nz = 4";
+        const char* lazy_path = "test_lazy.ini";
+        FILE* file = fopen(lazy_path, "wb");
+        TEST(file != NULL);
+        fwrite(data, 1, sizeof(data) - 1, file);
+        fclose(file);
+        HCINI hcini = cini_create_lazy(lazy_path);
+        TEST(cini_geti(hcini, "", "a", -999) == 1);
+        TEST(cini_geti(hcini, "s2", "y", -999) == 3);
+        TEST(cini_geterrorcount(hcini) == 0);
+        TEST(cini_geti(hcini, "s1", "x", -999) == 2);
+        TEST(cini_geti(hcini, "s1", "z", -999) == 4);
+        TEST(cini_geterrorcount(hcini) == 1);
+        TEST(strcmp(cini_geterror(hcini, 0), "Invalid section name (line:4)") == 0);
+        cini_free(hcini);
+        remove(lazy_path);
+        hcini = cini_create_lazy("alkjgbak4nubiato");
+        TEST(hcini != NULL);
+        TEST(cini_geterrorcount(hcini) == 1);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        cini_free(hcini);
+    }
+    // resolved key
+    {
+        HCINI hcini = cini_create(path);
+        CINI_KEY key01 = cini_lookup(hcini, "", "key01");
+        CINI_KEY array01 = cini_lookup(hcini, "array", "key01");
+        CINI_KEY nokey = cini_lookup(hcini, "", "key");
+        TEST(key01 != NULL);
+        TEST(nokey == NULL);
+        TEST(cini_key_geti(hcini, key01, -999) == 1234);
+        TEST(cini_key_getf(hcini, key01, -999.0f) == 1234.0f);
+        TEST(strcmp(cini_key_gets(hcini, key01, "ERROR"), "1234") == 0);
+        TEST(cini_key_getcount(hcini, array01) == 3);
+        TEST(cini_key_getai(hcini, array01, 2, -999) == 3);
+        TEST(cini_key_getai(hcini, array01, 3, -999) == -999);
+        TEST(cini_key_getai(hcini, array01, -1, -999) == -999);
+        TEST(cini_key_getaf(hcini, cini_lookup(hcini, "array", "key05"), 1, -999.0f) == -0.125f);
+        TEST(strcmp(cini_key_getas(hcini, cini_lookup(hcini, "array", "key06"), 2, "ERROR"), "CCC,DDDD") == 0);
+        TEST(cini_key_geti(hcini, nokey, -999) == -999);
+        TEST(strcmp(cini_key_gets(hcini, nokey, "ERROR"), "ERROR") == 0);
+        TEST(cini_key_getcount(hcini, nokey) == 0);
+        cini_free(hcini);
+    }
+    // compiled file
+    {
+        const char* compiled_path = "test.cini";
+        HCINI hcini = cini_create(path);
+        TEST(cini_save_compiled(hcini, compiled_path) != 0);
+        cini_free(hcini);
+
+        hcini = cini_create_compiled(compiled_path);
+        TEST(cini_geterrorcount(hcini) == 3);
+        TEST(strcmp(cini_geterror(hcini, 0), "Invalid section name (line:86)") == 0);
+        TEST(strcmp(cini_geterror(hcini, 2), "Invalid key name (line:88)") == 0);
+        TEST(cini_geterror(hcini, 3) == NULL);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        TEST(strcmp(cini_gets(hcini, "", "key02", "ERROR"), "TEST") == 0);
+        TEST(cini_geti(hcini, "", "key", -999) == -999);
+        TEST(cini_geti(hcini, "integer", "intmin", -999) == -2147483648LL);
+        TEST(cini_getf(hcini, "float", "key08", -999.0f) == 0.123456001f);
+        TEST(cini_geti(hcini, "string", "key08", -999) == -999);
+        TEST(cini_key_geti(hcini, cini_lookup(hcini, "integer", "intmin"), -999) == -2147483648LL);
+        TEST(cini_key_getcount(hcini, cini_lookup(hcini, "array", "key07")) == 6);
+        TEST(strcmp(cini_gets(hcini, "string", "key08", "ERROR"), "\"TEST\"") == 0);
+        TEST(cini_getcount(hcini, "array", "key07") == 6);
+        TEST(strcmp(cini_getas(hcini, "array", "key07", 2, "ERROR"), "C\"C\"C , C ") == 0);
+        TEST(cini_getaf(hcini, "array", "key05", 1, -999.0f) == -0.125f);
+        TEST(cini_getai(hcini, "array", "key01", 3, -999) == -999);
+        {
+            int iarray[4] = { -999, -999, -999, -999 };
+            TEST(cini_getai_range(hcini, "array", "key01", iarray, 4) == 3);
+            TEST(iarray[0] == 1 && iarray[1] == 2 && iarray[2] == 3 && iarray[3] == -999);
+        }
+        cini_free(hcini);
+        remove(compiled_path);
+    }
+    {
+        HCINI hcini = cini_create_with_section(path, "integer");
+        TEST(cini_save_compiled(hcini, "test_section.cini") == 0);
+        cini_free(hcini);
+    }
+    {
+        const char* source_path = "test_compiled.ini";
+        const char* compiled_path = "test_compiled.cini";
+        FILE* file = fopen(source_path, "wb");
+        TEST(file != NULL);
+        if (file != NULL) {
+            fprintf(file, "key01=1234\n");
+            fclose(file);
+        }
+        HCINI hcini = cini_create_mmap(source_path, NULL);
+        TEST(cini_save_compiled(hcini, compiled_path) != 0);
+        cini_free(hcini);
+
+        // Rewritten with the same content
+        file = fopen(source_path, "wb");
+        if (file != NULL) {
+            fprintf(file, "key01=1234\n");
+            fclose(file);
+        }
+        hcini = cini_create_compiled(compiled_path);
+        TEST(cini_geterrorcount(hcini) == 0);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        cini_free(hcini);
+
+        // Modified
+        file = fopen(source_path, "wb");
+        if (file != NULL) {
+            fprintf(file, "key01=56789\n");
+            fclose(file);
+        }
+        hcini = cini_create_compiled(compiled_path);
+        TEST(cini_geterrorcount(hcini) == 1);
+        TEST(strcmp(cini_geterror(hcini, 0), "Compiled file is out of date (line:0)") == 0);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        cini_free(hcini);
+
+        // Without the source
+        remove(source_path);
+        hcini = cini_create_compiled(compiled_path);
+        TEST(cini_geterrorcount(hcini) == 0);
+        TEST(cini_geti(hcini, "", "key01", -999) == 1234);
+        cini_free(hcini);
+        remove(compiled_path);
+    }
+    {
+        const char* compiled_path = "test_broken.cini";
+        FILE* file = fopen(compiled_path, "wb");
+        TEST(file != NULL);
+        if (file != NULL) {
+            fprintf(file, "CINI");
+            for (int i = 0; i < 256; i++) {
+                fputc(0xFF, file);
+            }
+            fclose(file);
+        }
+        HCINI hcini = cini_create_compiled(compiled_path);
+        TEST(cini_geterrorcount(hcini) == 1);
+        TEST(strcmp(cini_geterror(hcini, 0), "Invalid compiled file (line:0)") == 0);
+        TEST(cini_geti(hcini, "", "key01", -999) == -999);
+        cini_free(hcini);
+        remove(compiled_path);
+    }
+    {
+        HCINI hcini = cini_create_compiled("alkjgbak4nubiato");
+        TEST(hcini != NULL);
+        TEST(cini_geterrorcount(hcini) == 1);
+        cini_free(hcini);
+    }
 
     TEST_PRINT(stdout, "\n");
 
@@ -1,6 +1,40 @@
-﻿#include "cini.h"
+﻿#define CINI_LIVE
+#include "cini.h"
 #include "test.h"
+#include <atomic>
 #include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if CINI_HAS_CPP17
+struct TestConfig {
+    int count;
+    float ratio;
+    bool enabled;
+    const char* name;
+    std::string text;
+    int missing;
+    double precise;
+    uint64_t large;
+};
+
+template <>
+struct CiniSchema<TestConfig> {
+    static constexpr auto fields = std::make_tuple(
+        Cini::field("int section", "key1", &TestConfig::count, 0),
+        Cini::field("float section", "key2", &TestConfig::ratio, 0.0F),
+        Cini::field("int section", "key3", &TestConfig::enabled, false),
+        Cini::field("string section", "key1", &TestConfig::name, "ERROR"),
+        Cini::field("string section", "key2", &TestConfig::text, ""),
+        Cini::field("int section", "nokey", &TestConfig::missing, -999),
+        Cini::field("float section", "key1", &TestConfig::precise, 0.0),
+        Cini::field("int section", "key5", &TestConfig::large, 0));
+};
+
+static_assert(Cini::desc("", "").section_hash == 0x811c9dc5u);
+static_assert(Cini::desc("a", "").section_hash == 0xe40c292cu);
+#endif
 
 void test_cpp(const char* path)
 {
@@ -120,6 +154,11 @@ void test_cpp(const char* path)
         TEST(cini.getaf("array section", "key10", 0, -999.0F) == 1.23F);
         TEST(cini.getaf("array section", "key10", 1, -999.0F) == -0.125F);
         TEST(cini.getaf("array section", "key10", 2, -999.0F) == 1234.56F);
+        {
+            float farray[3] = { -999.0F, -999.0F, -999.0F };
+            TEST(cini.getaf_range("array section", "key10", farray, 3) == 3);
+            TEST(farray[0] == 1.23F && farray[1] == -0.125F && farray[2] == 1234.56F);
+        }
 
         TEST(cini.getcount("array section", "key2") == 4);
         TEST(strcmp(cini.getas("array section", "key2", 0, "ERROR"), "A") == 0);
@@ -179,6 +218,241 @@ void test_cpp(const char* path)
         Cini cini(path);
         TEST(cini.geterrorcount() == 3);
     }
+    {
+        Cini cini(path, { "int section", "string section" });
+        TEST(cini.geti("", "key1", -999) == -999);
+        TEST(cini.geti("int section", "key1", -999) == 200);
+        TEST(strcmp(cini.gets("string section", "key1", "ERROR"), "TEXT") == 0);
+        TEST(cini.getf("float section", "key1", -999.0F) == -999.0F);
+    }
+#if CINI_HAS_CPP17
+    {
+        std::string data = "key1=100\n[string section]\nkey1=TEXT\n";
+        Cini cini = Cini::from_buffer(data, "string section");
+        data.clear();
+        TEST(cini.geti("", "key1", -999) == -999);
+        TEST(strcmp(cini.gets("string section", "key1", "ERROR"), "TEXT") == 0);
+        TEST(cini.geterrorcount() == 0);
+    }
+#endif
+    {
+        const char* compiled_path = "test_cpp.cini";
+        TEST(Cini(path).save_compiled(compiled_path));
+        Cini cini(compiled_path, nullptr, Cini::COMPILED);
+        TEST(cini.geterrorcount() == 3);
+        TEST(cini.geti("int section", "key1", -999) == 200);
+        TEST(cini.getcount("array section", "key1") == 4);
+        remove(compiled_path);
+    }
+    {
+        Cini cini(path);
+        Cini::Key key1 = cini.lookup("int section", "key1");
+        Cini::Key array1 = cini.lookup("array section", "key1");
+        TEST(key1 && array1 && !cini.lookup("int section", "nokey"));
+        TEST(cini.geti(key1, -999) == 200);
+        TEST(strcmp(cini.gets(key1, "ERROR"), "200") == 0);
+        TEST(cini.getcount(array1) == 4);
+        TEST(cini.getai(array1, 1, -999) == 2);
+        TEST(cini.getf(Cini::Key(), -999.0F) == -999.0F);
+        TEST(cini.geti64(key1, -999) == 200);
+        TEST(cini.getau64(array1, 1, 999) == 2);
+        TEST(cini.geti64("int section", "key2", -999) == -50);
+        TEST(cini.getu64("int section", "key2", 999) == 999);
+        TEST(cini.getd("float section", "key1", -999.0) == 12.34);
+    }
+#if CINI_HAS_CPP17
+    {
+        Cini cini(path);
+        constexpr CINI_KEY_DESC key1 = Cini::desc("int section", "key1");
+        TEST(cini.lookup(key1) && cini.geti(cini.lookup(key1), -999) == 200);
+        TEST(!cini.lookup(Cini::desc("int section", "nokey")));
+        TestConfig config = cini.bind<TestConfig>();
+        TEST(config.count == 200);
+        TEST(config.ratio == -0.125F);
+        TEST(config.enabled);
+        TEST(strcmp(config.name, "TEXT") == 0);
+        TEST(config.text == "THIS IS A PEN.");
+        TEST(config.missing == -999);
+        TEST(config.precise == 12.34);
+        TEST(config.large == 0x99FF);
+        TEST(Cini(path, nullptr, Cini::COMPILED).bind<TestConfig>().missing == -999);
+    }
+#endif
+    {
+        std::vector<std::unique_ptr<Cini>> cinis = Cini::create_many({ path, "not_found.ini", path });
+        TEST(cinis.size() == 3);
+        TEST(cinis[0]->geti("int section", "key1", -999) == 200);
+        TEST(cinis[1]->geterrorcount() == 1);
+        TEST(cinis[2]->getcount("array section", "key1") == 4);
+    }
+    {
+        Cini cini(path, nullptr, Cini::PARALLEL);
+        TEST(cini.geti("int section", "key1", -999) == 200);
+        TEST(cini.getcount("array section", "key1") == 4);
+        TEST(Cini(path, "int section", Cini::PARALLEL).getcount("array section", "key1") == 0);
+    }
+    {
+        Cini cini(path, nullptr, Cini::LAZY);
+        TEST(cini.getstats().entry_count == 0);
+        TEST(cini.geti("int section", "key1", -999) == 200);
+        TEST(cini.getcount("array section", "key1") == 4);
+        TEST(Cini(path, "int section", Cini::LAZY).getcount("array section", "key1") == 0);
+    }
+    {
+        Cini cini(path);
+        TEST(0 < cini.getstats().memory_bytes);
+#if !defined(CINI_NO_INTERN)
+        TEST(cini.intern("key1") != nullptr);
+#endif
+        TEST(cini.intern("not found") == nullptr);
+    }
+    {
+        Cini cini(path, nullptr, Cini::MMAP | Cini::COMPACT);
+        TEST(cini.geti("int section", "key1", -999) == 200);
+        TEST(cini.getcount("array section", "key1") == 4);
+    }
+    {
+        int live_count = 0;
+        CINI_ALLOCATOR allocator = {
+            [](void* user_data, size_t size) -> void* { ++*(int*)user_data; return malloc(size); },
+            [](void* user_data, void* ptr) { --*(int*)user_data; free(ptr); },
+            &live_count,
+        };
+        {
+            Cini cini(path, allocator, "int section");
+            TEST(cini.geti("int section", "key1", -999) == 200);
+            TEST(cini.getcount("array section", "key1") == 0);
+            TEST(0 < live_count);
+        }
+        TEST(live_count == 0);
+    }
+    for (int flags : { 0, static_cast<int>(Cini::MMAP), static_cast<int>(Cini::COMPACT), static_cast<int>(Cini::LAZY) }) {
+        Cini cini(path, nullptr, flags);
+        int entry_count = 0;
+        bool found = false;
+        TEST(std::string((*cini.begin()).name()).empty());
+        for (Cini::Section section : cini) {
+            for (Cini::Entry entry : section) {
+                TEST(static_cast<bool>(cini.lookup(section.name(), entry.name())));
+                ++entry_count;
+            }
+            if (std::string(section.name()) == "int section") {
+                Cini::Entry entry = *section.begin();
+                TEST(std::string(entry.name()) == "key1");
+                TEST(entry.geti(-999) == 200);
+                TEST(cini.geti(entry.key(), -999) == 200);
+                found = true;
+            }
+        }
+        TEST(0 < entry_count);
+        TEST(found);
+    }
+    // multi-threading
+    for (int flags : { 0, static_cast<int>(Cini::MMAP), static_cast<int>(Cini::LAZY) }) {
+        Cini cini(path, nullptr, flags);
+        std::atomic<bool> start(false);
+        std::atomic<int> failures(0);
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 64; i++) {
+            readers.emplace_back([&cini, &start, &failures, flags] {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                for (int n = 0; n < 100; n++) {
+                    int ok = cini.geti("int section", "key1", -999) == 200
+                        && cini.getf("float section", "key2", -999.0F) == -0.125F
+                        && strcmp(cini.gets("string section", "key1", "ERROR"), "TEXT") == 0
+                        && cini.getcount("array section", "key1") == 4
+                        && cini.getai("array section", "key1", 2, -999) == 3
+                        && strcmp(cini.getas("array section", "key2", 2, "ERROR"), "CCC,DDDD") == 0
+                        && cini.geterrorcount() == ((flags & Cini::LAZY) ? 0 : 3); // The lazy handle has not parsed the error section
+                    if (!ok) {
+                        failures.fetch_add(1);
+                    }
+                }
+            });
+        }
+        start.store(true);
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        TEST(failures.load() == 0);
+    }
+    // reloadable
+    {
+        const char* live_path = "test_live.ini";
+        auto write_file = [live_path](const char* text) {
+            FILE* file = fopen(live_path, "wb");
+            if (file != NULL) {
+                fputs(text, file);
+                fclose(file);
+            }
+        };
+        write_file("[live]\nkey1=100\nkey2=TEXT\n");
+        {
+            CiniLive live(live_path, nullptr, 0, 0);
+            TEST(live.geti("live", "key1", -999) == 100);
+            TEST(live.gets("live", "key2", "ERROR") == "TEXT");
+            TEST(live.generation() == 0);
+
+            std::thread writer;
+            {
+                // The old data is kept while the snapshot refers to it
+                CiniLive::Snapshot snapshot = live.snapshot();
+                write_file("[live]\nkey1=2000\nkey2=TEXT2\n");
+                writer = std::thread([&live] { live.reload(); });
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                TEST(snapshot.geti("live", "key1", -999) == 100);
+                TEST(strcmp(snapshot.gets("live", "key2", "ERROR"), "TEXT") == 0);
+            }
+            writer.join();
+            TEST(live.generation() == 1);
+            TEST(live.geti("live", "key1", -999) == 2000);
+            TEST(live.getas("live", "key2", 0, "ERROR") == "TEXT2");
+
+            // Readers during reloading
+            std::atomic<bool> stop(false);
+            std::atomic<int> failures(0);
+            std::vector<std::thread> readers;
+            for (int i = 0; i < 4; i++) {
+                readers.emplace_back([&live, &stop, &failures] {
+                    while (!stop.load()) {
+                        CiniLive::Snapshot snapshot = live.snapshot();
+                        int i1 = snapshot.geti("live", "key1", -999);
+                        const char* s2 = snapshot.gets("live", "key2", "ERROR");
+                        if (!((i1 == 100 && strcmp(s2, "TEXT") == 0) || (i1 == 2000 && strcmp(s2, "TEXT2") == 0))) {
+                            failures.fetch_add(1);
+                        }
+                    }
+                });
+            }
+            for (int i = 0; i < 20; i++) {
+                write_file((i % 2) ? "[live]\nkey1=2000\nkey2=TEXT2\n" : "[live]\nkey1=100\nkey2=TEXT\n");
+                live.reload();
+            }
+            stop.store(true);
+            for (auto& reader : readers) {
+                reader.join();
+            }
+            TEST(failures.load() == 0);
+            TEST(live.generation() == 21);
+            TEST(live.geti("live", "key1", -999) == 2000);
+        }
+        {
+            // Watch the modification
+            CiniLive live(live_path, nullptr, Cini::MMAP, 10);
+            TEST(live.geti("live", "key1", -999) == 2000);
+            write_file("[live]\nkey1=30000\n");
+            for (int i = 0; i < 500 && live.generation() == 0; i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            TEST(live.generation() == 1);
+            TEST(live.geti("live", "key1", -999) == 30000);
+            remove(live_path);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            TEST(live.geti("live", "key1", -999) == 30000);
+        }
+    }
     {
         Cini cini("alkjgbak4nubiato");
         TEST(cini.geterrorcount() == 1);